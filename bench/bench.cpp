@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "histogram.h"
+#include "atomic_wait.h"
+#include "msg_queue.h"
+#include "posix_semaphore.h"
+#include "shared_hash_map.h"
+#include "shared_memory.h"
+
+namespace {
+
+    const long TIMEOUT_SECONDS = 5;
+    const size_t MAILBOX_PAYLOAD_SIZE = 256;
+    const size_t HASH_MAP_SIZE = 1024;
+
+    struct Options {
+        long iterations;
+        long warmup;
+        std::string filter;
+    };
+
+    //the two sides of the shared memory handoff live on separate cache lines
+    struct Mailbox {
+        alignas(ipclib::CACHE_LINE_SIZE) std::atomic<uint64_t> request;
+        alignas(ipclib::CACHE_LINE_SIZE) std::atomic<uint64_t> response;
+        alignas(ipclib::CACHE_LINE_SIZE) char payload[MAILBOX_PAYLOAD_SIZE];
+    };
+
+    Options options;
+
+    uint64_t getNow() {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (uint64_t)(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+    }
+
+    std::string getObjectName(const std::string& theRole) {
+        return "ipclib_bench_" + theRole + "." + std::to_string(getpid());
+    }
+
+    bool isSelected(const std::string& theName) {
+        return options.filter.empty() || theName.find(options.filter) != std::string::npos;
+    }
+
+    void printLatency(const std::string& theName, const ipclib::Histogram& theHistogram) {
+        std::cout << std::left << std::setw(44) << theName << std::right
+                  << std::setw(10) << theHistogram.getCount()
+                  << std::setw(10) << theHistogram.getMin()
+                  << std::setw(10) << theHistogram.getPercentile(50.0)
+                  << std::setw(10) << theHistogram.getPercentile(90.0)
+                  << std::setw(10) << theHistogram.getPercentile(99.0)
+                  << std::setw(10) << theHistogram.getPercentile(99.9)
+                  << std::setw(10) << theHistogram.getMax() << "\n";
+    }
+
+    void printThroughput(const std::string& theName, const long theCount, const size_t theSize, const uint64_t theElapsed) {
+        double seconds = theElapsed / 1e9;
+        std::cout << std::left << std::setw(44) << theName << std::right
+                  << std::setw(10) << theCount
+                  << std::setw(14) << std::fixed << std::setprecision(0) << theCount / seconds << " msg/s"
+                  << std::setw(12) << std::setprecision(1) << theCount * (double)(theSize) / seconds / (1 << 20) << " MiB/s\n";
+    }
+
+    void printFailure(const std::string& theName, const ipclib::Result& theResult) {
+        std::cout << std::left << std::setw(44) << theName << std::right << "  FAILED: " << theResult.getDescription() << "\n";
+    }
+
+    //the child only ever runs one side of a benchmark and leaves through _exit, so no destructor runs twice
+    bool finishChild(const pid_t theChild, const bool hasSucceeded) {
+        if( !hasSucceeded ) kill(theChild, SIGKILL);
+
+        int status;
+        waitpid(theChild, &status, 0);
+        return hasSucceeded && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    void runMsgQueuePingPong(const size_t theSize, const long theDepth) {
+        std::string name = "msg_queue.pingpong size=" + std::to_string(theSize) + " depth=" + std::to_string(theDepth);
+        if( !isSelected(name) ) return;
+
+        ipclib::MsgQueue ping(getObjectName("ping"), true, true, false, ipclib::MsgQueue::READ_AND_WRITE, theDepth, theSize);
+        ipclib::MsgQueue pong(getObjectName("pong"), true, true, false, ipclib::MsgQueue::READ_AND_WRITE, theDepth, theSize);
+        if( !ping.getInitializationResult() || !pong.getInitializationResult() ) {
+            printFailure(name, !ping.getInitializationResult() ? ping.getInitializationResult() : pong.getInitializationResult());
+            ping.destroy();
+            pong.destroy();
+            return;
+        }
+
+        std::vector<char> buffer(theSize, 'x');
+        long total = options.warmup + options.iterations;
+
+        pid_t child = fork();
+        if( child == 0 ) {
+            size_t received;
+            for( long i = 0; i < total; i++ ) {
+                if( !ping.receiveBytes(&buffer[0], theSize, received) || !pong.sendBytes(&buffer[0], received) ) _exit(1);
+            }
+
+            _exit(0);
+        }
+
+        ipclib::Histogram histogram;
+        ipclib::Result res;
+        for( long i = 0; i < total && res; i++ ) {
+            size_t received;
+            uint64_t start = getNow();
+            if( (res = ping.sendBytes(&buffer[0], theSize)) ) res = pong.receiveBytes(&buffer[0], theSize, received, TIMEOUT_SECONDS);
+            if( i >= options.warmup ) histogram.record(getNow() - start);
+        }
+
+        if( finishChild(child, res) ) printLatency(name, histogram);
+        else printFailure(name, res);
+
+        ping.destroy();
+        pong.destroy();
+    }
+
+    void runMsgQueueStream(const size_t theSize, const long theDepth) {
+        std::string name = "msg_queue.stream size=" + std::to_string(theSize) + " depth=" + std::to_string(theDepth);
+        if( !isSelected(name) ) return;
+
+        ipclib::MsgQueue data(getObjectName("data"), true, true, false, ipclib::MsgQueue::READ_AND_WRITE, theDepth, theSize);
+        ipclib::MsgQueue done(getObjectName("done"), true, true, false, ipclib::MsgQueue::READ_AND_WRITE, 1, sizeof(long));
+        if( !data.getInitializationResult() || !done.getInitializationResult() ) {
+            printFailure(name, !data.getInitializationResult() ? data.getInitializationResult() : done.getInitializationResult());
+            data.destroy();
+            done.destroy();
+            return;
+        }
+
+        std::vector<char> buffer(theSize, 'x');
+        long total = options.iterations * 4;
+
+        pid_t child = fork();
+        if( child == 0 ) {
+            size_t received;
+            for( long i = 0; i < total; i++ ) {
+                if( !data.receiveBytes(&buffer[0], theSize, received) ) _exit(1);
+            }
+
+            _exit(done.send(total) ? 0 : 1);
+        }
+
+        ipclib::Result res;
+        uint64_t start = getNow();
+        for( long i = 0; i < total && res; i++ ) res = data.sendBytes(&buffer[0], theSize, TIMEOUT_SECONDS);
+
+        long count = 0;
+        if( res ) res = done.receive(count, TIMEOUT_SECONDS);
+        uint64_t elapsed = getNow() - start;
+
+        if( finishChild(child, res) ) printThroughput(name, count, theSize, elapsed);
+        else printFailure(name, res);
+
+        data.destroy();
+        done.destroy();
+    }
+
+    void runSemaphoreHandoff() {
+        std::string name = "semaphore.handoff";
+        if( !isSelected(name) ) return;
+
+        ipclib::Semaphore ping(getObjectName("ping"), true, true, 0);
+        ipclib::Semaphore pong(getObjectName("pong"), true, true, 0);
+        if( !ping.getInitializationResult() || !pong.getInitializationResult() ) {
+            printFailure(name, !ping.getInitializationResult() ? ping.getInitializationResult() : pong.getInitializationResult());
+            ping.destroy();
+            pong.destroy();
+            return;
+        }
+
+        long total = options.warmup + options.iterations;
+
+        pid_t child = fork();
+        if( child == 0 ) {
+            for( long i = 0; i < total; i++ ) {
+                if( !ping.wait() || !pong.signal() ) _exit(1);
+            }
+
+            _exit(0);
+        }
+
+        ipclib::Histogram histogram;
+        ipclib::Result res;
+        for( long i = 0; i < total && res; i++ ) {
+            uint64_t start = getNow();
+            if( (res = ping.signal()) ) res = pong.wait(TIMEOUT_SECONDS);
+            if( i >= options.warmup ) histogram.record(getNow() - start);
+        }
+
+        if( finishChild(child, res) ) printLatency(name, histogram);
+        else printFailure(name, res);
+
+        ping.destroy();
+        pong.destroy();
+    }
+
+    //yields now and then, so the handoff still makes progress when both processes share a CPU
+    bool waitForValue(const std::atomic<uint64_t>& theWord, const uint64_t theValue, const uint64_t theDeadline) {
+        for( unsigned int i = 1; theWord.load(std::memory_order_acquire) != theValue; i++ ) {
+            ipclib::cpuRelax();
+            if( i % 1024 == 0 ) {
+                if( getNow() > theDeadline ) return false;
+                sched_yield();
+            }
+        }
+
+        return true;
+    }
+
+    void runSharedMemoryHandoff() {
+        std::string name = "shared_memory.handoff size=" + std::to_string(MAILBOX_PAYLOAD_SIZE);
+        if( !isSelected(name) ) return;
+
+        ipclib::SharedMemory<Mailbox> mailbox(getObjectName("mailbox"), true, true);
+        if( !mailbox.getInitializationResult() ) {
+            printFailure(name, mailbox.getInitializationResult());
+            mailbox.destroy();
+            return;
+        }
+
+        Mailbox& box = mailbox.getValue();
+        box.request.store(0, std::memory_order_relaxed);
+        box.response.store(0, std::memory_order_relaxed);
+        long total = options.warmup + options.iterations;
+
+        pid_t child = fork();
+        if( child == 0 ) {
+            char payload[MAILBOX_PAYLOAD_SIZE];
+            for( long i = 1; i <= total; i++ ) {
+                if( !waitForValue(box.request, i, getNow() + TIMEOUT_SECONDS * 1000000000ULL) ) _exit(1);
+                memcpy(payload, box.payload, MAILBOX_PAYLOAD_SIZE);
+                box.response.store(i, std::memory_order_release);
+            }
+
+            _exit(0);
+        }
+
+        ipclib::Histogram histogram;
+        bool succeeded = true;
+        char payload[MAILBOX_PAYLOAD_SIZE];
+        memset(payload, 'x', MAILBOX_PAYLOAD_SIZE);
+        for( long i = 1; i <= total && succeeded; i++ ) {
+            uint64_t start = getNow();
+            memcpy(box.payload, payload, MAILBOX_PAYLOAD_SIZE);
+            box.request.store(i, std::memory_order_release);
+            succeeded = waitForValue(box.response, i, start + TIMEOUT_SECONDS * 1000000000ULL);
+            if( i > options.warmup ) histogram.record(getNow() - start);
+        }
+
+        if( finishChild(child, succeeded) ) printLatency(name, histogram);
+        else printFailure(name, ipclib::Result(ETIMEDOUT));
+
+        mailbox.destroy();
+    }
+
+    //every worker churns through fresh keys of its own, so tombstones pile up and inserts have to compact the table
+    //the workers attach by name and check every insert, find and erase, a lost or stale key fails the run
+    void runSharedHashMapChurn(const long theWorkers) {
+        std::string name = "shared_hash_map.churn workers=" + std::to_string(theWorkers);
+        if( !isSelected(name) ) return;
+
+        typedef ipclib::SharedHashMap<uint64_t, uint64_t> Map;
+
+        std::string mapName = getObjectName("map");
+        Map map(mapName, HASH_MAP_SIZE, 0.75, true, true);
+        if( !map.getInitializationResult() ) {
+            printFailure(name, map.getInitializationResult());
+            map.destroy();
+            return;
+        }
+
+        //one more key than live is held between an insert and the following erase
+        long live = HASH_MAP_SIZE / theWorkers - 1;
+        long total = options.iterations;
+
+        std::vector<pid_t> children;
+        uint64_t start = getNow();
+        for( long worker = 0; worker < theWorkers; worker++ ) {
+            pid_t child = fork();
+            if( child == 0 ) {
+                Map peer(mapName, HASH_MAP_SIZE, 0.75, false);
+                if( !peer.getInitializationResult() ) _exit(1);
+
+                for( long i = 0; i < total; i++ ) {
+                    uint64_t key = i * theWorkers + worker;
+                    uint64_t value = 0;
+                    if( !peer.insert(key, ~key) || !peer.find(key, value) || value != ~key ) _exit(1);
+
+                    if( i >= live ) {
+                        uint64_t old = (i - live) * theWorkers + worker;
+                        if( !peer.erase(old) || peer.contains(old) ) _exit(1);
+                    }
+                }
+
+                _exit(0);
+            }
+
+            children.push_back(child);
+        }
+
+        bool succeeded = true;
+        for( size_t i = 0; i < children.size(); i++ ) succeeded = finishChild(children[i], true) && succeeded;
+        uint64_t elapsed = getNow() - start;
+
+        if( succeeded && map.getSize() == (size_t)(theWorkers * std::min(live, total)) ) printThroughput(name, total * theWorkers, 2 * sizeof(uint64_t), elapsed);
+        else printFailure(name, ipclib::Result(EPROTO, "Map lost or kept a key"));
+
+        map.destroy();
+    }
+
+}
+
+//ipclib_bench [-n iterations] [filter]: every benchmark forks a peer process, latencies are round trips in ns
+int main(int argc, char** argv) {
+    options.iterations = 100000;
+    options.warmup = 1000;
+
+    for( int i = 1; i < argc; i++ ) {
+        if( strcmp(argv[i], "-n") == 0 && i + 1 < argc ) options.iterations = atol(argv[++i]);
+        else options.filter = argv[i];
+    }
+
+    if( options.iterations <= 0 ) {
+        std::cerr << "usage: " << argv[0] << " [-n iterations] [filter]\n";
+        return 1;
+    }
+
+    const size_t sizes[] = { 16, 256, 4096 };
+    const long depths[] = { 1, 10 };
+
+    std::cout << std::left << std::setw(44) << "latency (round trip, ns)" << std::right
+              << std::setw(10) << "count" << std::setw(10) << "min" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+
+    for( size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++ ) runMsgQueuePingPong(sizes[i], 1);
+    runSemaphoreHandoff();
+    runSharedMemoryHandoff();
+
+    std::cout << "\n" << std::left << std::setw(44) << "throughput" << std::right << std::setw(10) << "count" << "\n";
+
+    for( size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++ ) {
+        for( size_t j = 0; j < sizeof(depths) / sizeof(depths[0]); j++ ) runMsgQueueStream(sizes[i], depths[j]);
+    }
+
+    runSharedHashMapChurn(4);
+
+    return 0;
+}
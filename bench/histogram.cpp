@@ -0,0 +1,66 @@
+#include "histogram.h"
+
+#include <math.h>
+
+ipclib::Histogram::Histogram() {
+    counts.resize(getIndex(UINT64_MAX) + 1);
+    reset();
+}
+
+size_t ipclib::Histogram::getIndex(const uint64_t theValue) {
+    if( theValue < LINEAR_LIMIT ) return theValue;
+
+    //the shift brings theValue in [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT)
+    unsigned int shift = (63 - __builtin_clzll(theValue)) - SUB_BUCKET_BITS;
+    return LINEAR_LIMIT + (shift - 1) * SUB_BUCKET_COUNT + ((theValue >> shift) - SUB_BUCKET_COUNT);
+}
+
+uint64_t ipclib::Histogram::getHighestEquivalentValue(const size_t theIndex) {
+    if( theIndex < LINEAR_LIMIT ) return theIndex;
+
+    unsigned int shift = (theIndex - LINEAR_LIMIT) / SUB_BUCKET_COUNT + 1;
+    uint64_t sub_bucket = (theIndex - LINEAR_LIMIT) % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return (sub_bucket << shift) + ((1ULL << shift) - 1);
+}
+
+uint64_t ipclib::Histogram::getPercentile(const double thePercentile) const {
+    if( !total ) return 0;
+
+    uint64_t target = (uint64_t)(ceil(thePercentile / 100.0 * total));
+    if( target == 0 ) target = 1;
+
+    uint64_t seen = 0;
+    for( size_t i = 0; i < counts.size(); i++ ) {
+        seen = seen + counts[i];
+        if( seen >= target ) {
+            uint64_t value = getHighestEquivalentValue(i);
+            return value < max ? value : max;
+        }
+    }
+
+    return max;
+}
+
+void ipclib::Histogram::record(const uint64_t theValue) {
+    counts[getIndex(theValue)]++;
+    total++;
+    sum = sum + theValue;
+    if( theValue < min ) min = theValue;
+    if( theValue > max ) max = theValue;
+}
+
+void ipclib::Histogram::merge(const Histogram& theHistogram) {
+    for( size_t i = 0; i < counts.size(); i++ ) counts[i] = counts[i] + theHistogram.counts[i];
+    total = total + theHistogram.total;
+    sum = sum + theHistogram.sum;
+    if( theHistogram.total && theHistogram.min < min ) min = theHistogram.min;
+    if( theHistogram.max > max ) max = theHistogram.max;
+}
+
+void ipclib::Histogram::reset() {
+    for( size_t i = 0; i < counts.size(); i++ ) counts[i] = 0;
+    total = 0;
+    min = UINT64_MAX;
+    max = 0;
+    sum = 0;
+}
@@ -0,0 +1,43 @@
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace ipclib {
+
+    //log-linear buckets in the HdrHistogram fashion: values below 128 are exact, above that every
+    //power of two is split in 64 sub buckets, so a reported percentile is never more than 1.6% off
+    class Histogram {
+        private:
+            static const unsigned int SUB_BUCKET_BITS = 6;
+            static const uint64_t SUB_BUCKET_COUNT = 1ULL << SUB_BUCKET_BITS;
+            static const uint64_t LINEAR_LIMIT = SUB_BUCKET_COUNT << 1;
+
+            std::vector<uint64_t> counts;
+            uint64_t total;
+            uint64_t min;
+            uint64_t max;
+            long double sum;
+
+            static size_t getIndex(const uint64_t theValue);
+            static uint64_t getHighestEquivalentValue(const size_t theIndex);
+
+        public:
+            Histogram();
+
+            uint64_t getCount() const { return total; }
+            uint64_t getMin() const { return total ? min : 0; }
+            uint64_t getMax() const { return max; }
+            double getMean() const { return total ? (double)(sum / total) : 0; }
+            uint64_t getPercentile(const double thePercentile) const;
+
+            void record(const uint64_t theValue);
+            void merge(const Histogram& theHistogram);
+            void reset();
+    };
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _ARENA_ALLOCATOR_H_
+#define _ARENA_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+
+#include "offset_ptr.h"
+#include "shared_arena.h"
+
+namespace ipclib {
+
+    //the arena is referenced through an OffsetPtr too, so containers can live inside the same segment they allocate from
+    template<class T> class ArenaAllocator {
+        static_assert(alignof(T) <= SharedArena::ALIGNMENT, "SharedArena blocks are only 16 byte aligned");
+
+        private:
+            OffsetPtr<SharedArena::Header> arena;
+
+            template<class U> friend class ArenaAllocator;
+
+        public:
+            typedef T value_type;
+            typedef OffsetPtr<T> pointer;
+            typedef OffsetPtr<const T> const_pointer;
+            typedef OffsetPtr<void> void_pointer;
+            typedef OffsetPtr<const void> const_void_pointer;
+            typedef std::size_t size_type;
+            typedef std::ptrdiff_t difference_type;
+
+            template<class U> struct rebind { typedef ArenaAllocator<U> other; };
+
+            ArenaAllocator(const SharedArena& theArena) : arena(theArena.getHeader()) {}
+            ArenaAllocator(SharedArena::Header* theHeader) : arena(theHeader) {}
+            ArenaAllocator(const ArenaAllocator& theAllocator) : arena(theAllocator.arena) {}
+            template<class U> ArenaAllocator(const ArenaAllocator<U>& theAllocator) : arena(theAllocator.arena) {}
+
+            ArenaAllocator& operator=(const ArenaAllocator& theAllocator) { arena = theAllocator.arena; return *this; }
+
+            SharedArena::Header* getArena() const { return arena.get(); }
+
+            pointer allocate(const size_type theCount);
+            void deallocate(pointer thePointer, const size_type) { SharedArena::deallocate(arena.get(), thePointer.get()); }
+
+            template<class U> bool operator==(const ArenaAllocator<U>& theAllocator) const { return arena.get() == theAllocator.arena.get(); }
+            template<class U> bool operator!=(const ArenaAllocator<U>& theAllocator) const { return arena.get() != theAllocator.arena.get(); }
+    };
+
+    template<class T> typename ArenaAllocator<T>::pointer ArenaAllocator<T>::allocate(const size_type theCount) {
+        //like std::allocator, a count whose size wraps around is refused instead of handing out a short block
+        if( theCount > SIZE_MAX / sizeof(T) ) throw std::bad_array_new_length();
+
+        void* address = SharedArena::allocate(arena.get(), theCount * sizeof(T));
+        if( !address ) throw std::bad_alloc();
+        return pointer((T*)(address));
+    }
+
+}
+
+#endif
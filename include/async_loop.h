@@ -0,0 +1,370 @@
+#ifndef _ASYNC_LOOP_H_
+#define _ASYNC_LOOP_H_
+
+//coroutines need C++20 while the library itself builds as C++11, so everything in here is header only
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <list>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <errno.h>
+#include <stdint.h>
+
+#include "event.h"
+#include "msg_queue.h"
+#include "posix_semaphore.h"
+#include "reactor.h"
+#include "result.h"
+
+namespace ipclib {
+
+    //fire and forget coroutine, it starts right away and frees its own frame when it returns
+    struct AsyncTask {
+        struct promise_type {
+            AsyncTask get_return_object() { return AsyncTask(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    //resumes coroutines suspended on MsgQueue, Semaphore and Event operations from a single thread
+    //queues have to be opened non blocking: every operation is attempted first and only suspends on EAGAIN
+    //POSIX semaphores have no descriptor, so while any coroutine waits on one the loop wakes up every poll interval
+    //and retries one waiter per semaphore: that is a sem_trywait per awaited semaphore per interval even when idle,
+    //and up to an interval of latency per wakeup. Raise the interval where latency matters less than that cost,
+    //or signal through an Event, which is woken by its descriptor
+    class AsyncLoop {
+        public:
+            static const int DEFAULT_SEMAPHORE_POLL_INTERVAL = 1;
+
+            class Waiter {
+                friend class AsyncLoop;
+
+                private:
+                    AsyncLoop* loop;
+                    std::coroutine_handle<> handle;
+
+                protected:
+                    int descriptor;
+                    uint32_t interest;
+                    const void* source;
+                    Result result;
+
+                    Waiter(AsyncLoop* theLoop, const int theDescriptor, const uint32_t theInterest, const void* theSource) { loop = theLoop; descriptor = theDescriptor; interest = theInterest; source = theSource; }
+                    virtual ~Waiter() {}
+
+                    //returns false while the operation would still block
+                    virtual bool tryComplete() = 0;
+
+                public:
+                    bool await_ready() { return tryComplete(); }
+                    bool await_suspend(std::coroutine_handle<> theHandle) { return loop->suspend(*this, theHandle); }
+                    Result await_resume() { return result; }
+            };
+
+            template<class Operation> class Awaitable : public Waiter {
+                private:
+                    Operation operation;
+
+                protected:
+                    bool tryComplete() override {
+                        result = operation();
+                        return result.getError() != EAGAIN;
+                    }
+
+                public:
+                    Awaitable(AsyncLoop* theLoop, const int theDescriptor, const uint32_t theInterest, const Operation& theOperation, const void* theSource = nullptr) : Waiter(theLoop, theDescriptor, theInterest, theSource), operation(theOperation) {}
+            };
+
+        private:
+            struct Descriptor {
+                std::list<Waiter*> waiters;
+                uint32_t interest;
+            };
+
+            Reactor reactor;
+            Event wakeup;
+            std::atomic<bool> stopped;
+            std::map<int, Descriptor> descriptors;
+            std::list<Waiter*> polled;
+            std::vector<Waiter*> ready;
+            size_t waiter_number;
+            int semaphore_poll_interval;
+            Result initialization_result;
+
+            bool suspend(Waiter& theWaiter, std::coroutine_handle<> theHandle);
+            Result updateInterest(const int theDescriptor);
+            void complete(std::list<Waiter*>& theWaiters, const uint32_t theEvents, const bool isSameDescriptor);
+            void onReady(const int theDescriptor, const uint32_t theEvents);
+            void poll();
+            static Result checkNonBlocking(MsgQueue& theQueue);
+
+        public:
+            AsyncLoop();
+            AsyncLoop(const AsyncLoop&) = delete;
+            AsyncLoop& operator=(const AsyncLoop&) = delete;
+
+            Result getInitializationResult() const { return initialization_result; }
+            Reactor& getReactor() { return reactor; }
+            size_t getWaiterNumber() const { return waiter_number; }
+            int getSemaphorePollInterval() const { return semaphore_poll_interval; }
+            Result setSemaphorePollInterval(const int theInterval);
+
+            Result runOnce(const int theTimeout = -1);
+            Result run();
+            Result stop();
+
+            auto receive(MsgQueue& theQueue, std::string& theBuffer);
+            auto send(MsgQueue& theQueue, const std::string& theMsg);
+            auto receiveBytes(MsgQueue& theQueue, void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize);
+            auto sendBytes(MsgQueue& theQueue, const void* theData, const size_t theSize);
+            template<class T> auto receive(MsgQueue& theQueue, T& theValue) requires IsMsgType<T>::value;
+            template<class T> auto send(MsgQueue& theQueue, const T& theValue) requires IsMsgType<T>::value;
+            auto wait(Semaphore& theSemaphore);
+            auto wait(Event& theEvent, uint64_t& theCount);
+
+            virtual ~AsyncLoop();
+    };
+
+    inline AsyncLoop::AsyncLoop() : stopped(false) {
+        waiter_number = 0;
+        semaphore_poll_interval = DEFAULT_SEMAPHORE_POLL_INTERVAL;
+
+        initialization_result = reactor.getInitializationResult();
+        if( !initialization_result ) return;
+
+        initialization_result = wakeup.create(0, true);
+        if( !initialization_result ) return;
+
+        initialization_result = reactor.add(wakeup, [this](const uint32_t) { wakeup.consume(); });
+    }
+
+    //frames still suspended here can never be resumed again, so they are destroyed with the loop
+    inline AsyncLoop::~AsyncLoop() {
+        std::vector< std::coroutine_handle<> > handles;
+        for( std::map<int, Descriptor>::iterator it = descriptors.begin(); it != descriptors.end(); ++it ) {
+            for( Waiter* waiter : it->second.waiters ) handles.push_back(waiter->handle);
+            reactor.remove(it->first);
+        }
+        for( Waiter* waiter : polled ) handles.push_back(waiter->handle);
+
+        descriptors.clear();
+        polled.clear();
+        for( std::coroutine_handle<> handle : handles ) handle.destroy();
+    }
+
+    //in milliseconds, it only bounds how long the reactor sleeps, so it takes effect from the next runOnce
+    inline Result AsyncLoop::setSemaphorePollInterval(const int theInterval) {
+        if( theInterval < 1 ) return Result(EINVAL, "The poll interval has to be at least a millisecond");
+
+        semaphore_poll_interval = theInterval;
+        return Result(Result::SUCCESS);
+    }
+
+    inline Result AsyncLoop::checkNonBlocking(MsgQueue& theQueue) {
+        if( theQueue.isNonBlocking() ) return Result(Result::SUCCESS);
+        else return Result(EINVAL, "Only non blocking queues can be awaited");
+    }
+
+    //returning false resumes the coroutine right away, that is how a registration failure reaches it
+    inline bool AsyncLoop::suspend(Waiter& theWaiter, std::coroutine_handle<> theHandle) {
+        theWaiter.handle = theHandle;
+
+        if( theWaiter.descriptor == -1 ) {
+            polled.push_back(&theWaiter);
+            waiter_number++;
+            return true;
+        }
+
+        Descriptor& descriptor = descriptors[theWaiter.descriptor];
+        if( descriptor.waiters.empty() ) descriptor.interest = 0;
+        descriptor.waiters.push_back(&theWaiter);
+
+        Result res = updateInterest(theWaiter.descriptor);
+        if( !res ) {
+            descriptors[theWaiter.descriptor].waiters.pop_back();
+            updateInterest(theWaiter.descriptor);
+            theWaiter.result = res;
+            return false;
+        }
+
+        waiter_number++;
+        return true;
+    }
+
+    //the descriptor stays in epoll only while someone waits on it, a level triggered idle queue would spin the loop
+    inline Result AsyncLoop::updateInterest(const int theDescriptor) {
+        std::map<int, Descriptor>::iterator it = descriptors.find(theDescriptor);
+        if( it == descriptors.end() ) return Result(Result::SUCCESS);
+
+        uint32_t interest = 0;
+        for( Waiter* waiter : it->second.waiters ) interest = interest | waiter->interest;
+
+        Result res(Result::SUCCESS);
+        if( !interest ) {
+            if( it->second.interest ) res = reactor.remove(theDescriptor);
+            descriptors.erase(it);
+            return res;
+        }
+
+        if( !it->second.interest ) res = reactor.add(theDescriptor, [this, theDescriptor](const uint32_t theEvents) { onReady(theDescriptor, theEvents); }, interest);
+        else if( it->second.interest != interest ) res = reactor.modify(theDescriptor, interest);
+
+        if( res ) it->second.interest = interest;
+        return res;
+    }
+
+    //waiters are served in arrival order, one which still gets EAGAIN keeps its place
+    //on a shared descriptor the waiters behind it with the same interest are not even tried, they would only burn a syscall each
+    inline void AsyncLoop::complete(std::list<Waiter*>& theWaiters, const uint32_t theEvents, const bool isSameDescriptor) {
+        uint32_t events = theEvents;
+        if( events & (EPOLLERR | EPOLLHUP) ) events = events | Reactor::READABLE_AND_WRITABLE;
+
+        std::list<Waiter*>::iterator it = theWaiters.begin();
+        while( it != theWaiters.end() && events ) {
+            if( !(events & (*it)->interest) ) {
+                ++it;
+                continue;
+            }
+
+            if( (*it)->tryComplete() ) {
+                ready.push_back(*it);
+                it = theWaiters.erase(it);
+                waiter_number--;
+            }
+
+            else {
+                if( isSameDescriptor ) events = events & ~((*it)->interest);
+                ++it;
+            }
+        }
+    }
+
+    //coroutines are resumed only once the bookkeeping is done, since they may suspend on the same descriptor again
+    inline void AsyncLoop::onReady(const int theDescriptor, const uint32_t theEvents) {
+        std::map<int, Descriptor>::iterator it = descriptors.find(theDescriptor);
+        if( it == descriptors.end() ) return;
+
+        ready.clear();
+        complete(it->second.waiters, theEvents, true);
+        updateInterest(theDescriptor);
+
+        std::vector<Waiter*> resumed;
+        resumed.swap(ready);
+        for( Waiter* waiter : resumed ) waiter->handle.resume();
+    }
+
+    //once a semaphore said EAGAIN the waiters queued behind it on the same semaphore are not tried this round
+    inline void AsyncLoop::poll() {
+        std::vector<const void*> exhausted;
+
+        std::list<Waiter*>::iterator it = polled.begin();
+        while( it != polled.end() ) {
+            if( std::find(exhausted.begin(), exhausted.end(), (*it)->source) != exhausted.end() ) {
+                ++it;
+                continue;
+            }
+
+            if( (*it)->tryComplete() ) {
+                ready.push_back(*it);
+                it = polled.erase(it);
+                waiter_number--;
+            }
+
+            else {
+                exhausted.push_back((*it)->source);
+                ++it;
+            }
+        }
+    }
+
+    inline Result AsyncLoop::runOnce(const int theTimeout) {
+        int timeout = theTimeout;
+        if( !polled.empty() && (timeout < 0 || timeout > semaphore_poll_interval) ) timeout = semaphore_poll_interval;
+
+        Result res = reactor.runOnce(timeout);
+        if( !res || polled.empty() ) return res;
+
+        ready.clear();
+        poll();
+
+        std::vector<Waiter*> resumed;
+        resumed.swap(ready);
+        for( Waiter* waiter : resumed ) waiter->handle.resume();
+
+        return res;
+    }
+
+    inline Result AsyncLoop::run() {
+        Result res(Result::SUCCESS);
+        while( res && !stopped.load(std::memory_order_acquire) ) res = runOnce();
+
+        stopped.store(false, std::memory_order_relaxed);
+        return res;
+    }
+
+    inline Result AsyncLoop::stop() {
+        stopped.store(true, std::memory_order_release);
+        return wakeup.signal();
+    }
+
+    inline auto AsyncLoop::receive(MsgQueue& theQueue, std::string& theBuffer) {
+        Result res = checkNonBlocking(theQueue);
+        auto operation = [res, &theQueue, &theBuffer]() { return res ? theQueue.receive(theBuffer) : res; };
+        return Awaitable<decltype(operation)>(this, theQueue.getDescriptor(), Reactor::READABLE, operation);
+    }
+
+    inline auto AsyncLoop::send(MsgQueue& theQueue, const std::string& theMsg) {
+        Result res = checkNonBlocking(theQueue);
+        auto operation = [res, &theQueue, &theMsg]() { return res ? theQueue.send(theMsg) : res; };
+        return Awaitable<decltype(operation)>(this, theQueue.getDescriptor(), Reactor::WRITABLE, operation);
+    }
+
+    inline auto AsyncLoop::receiveBytes(MsgQueue& theQueue, void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize) {
+        Result res = checkNonBlocking(theQueue);
+        auto operation = [res, &theQueue, theBuffer, theBufferSize, &theReceivedSize]() { return res ? theQueue.receiveBytes(theBuffer, theBufferSize, theReceivedSize) : res; };
+        return Awaitable<decltype(operation)>(this, theQueue.getDescriptor(), Reactor::READABLE, operation);
+    }
+
+    inline auto AsyncLoop::sendBytes(MsgQueue& theQueue, const void* theData, const size_t theSize) {
+        Result res = checkNonBlocking(theQueue);
+        auto operation = [res, &theQueue, theData, theSize]() { return res ? theQueue.sendBytes(theData, theSize) : res; };
+        return Awaitable<decltype(operation)>(this, theQueue.getDescriptor(), Reactor::WRITABLE, operation);
+    }
+
+    template<class T> auto AsyncLoop::receive(MsgQueue& theQueue, T& theValue) requires IsMsgType<T>::value {
+        Result res = checkNonBlocking(theQueue);
+        auto operation = [res, &theQueue, &theValue]() { return res ? theQueue.receive(theValue) : res; };
+        return Awaitable<decltype(operation)>(this, theQueue.getDescriptor(), Reactor::READABLE, operation);
+    }
+
+    template<class T> auto AsyncLoop::send(MsgQueue& theQueue, const T& theValue) requires IsMsgType<T>::value {
+        Result res = checkNonBlocking(theQueue);
+        auto operation = [res, &theQueue, &theValue]() { return res ? theQueue.send(theValue) : res; };
+        return Awaitable<decltype(operation)>(this, theQueue.getDescriptor(), Reactor::WRITABLE, operation);
+    }
+
+    inline auto AsyncLoop::wait(Semaphore& theSemaphore) {
+        auto operation = [&theSemaphore]() { return theSemaphore.tryWait(); };
+        return Awaitable<decltype(operation)>(this, -1, Reactor::READABLE, operation, &theSemaphore);
+    }
+
+    //the event has to be non blocking, which is how Event is created by default
+    inline auto AsyncLoop::wait(Event& theEvent, uint64_t& theCount) {
+        auto operation = [&theEvent, &theCount]() { return theEvent.consume(theCount); };
+        return Awaitable<decltype(operation)>(this, theEvent.getDescriptor(), Reactor::READABLE, operation);
+    }
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef _ATOMIC_WAIT_H_
+#define _ATOMIC_WAIT_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace ipclib {
+
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32 bit integers");
+
+    inline void cpuRelax() {
+        #if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+        #elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+        #else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        #endif
+    }
+
+    inline void getMonotonicDeadline(const long theSeconds, const long theNanoSeconds, timespec& theDeadline) {
+        clock_gettime(CLOCK_MONOTONIC, &theDeadline);
+
+        theDeadline.tv_sec = theDeadline.tv_sec + theSeconds + theNanoSeconds / 1000000000L;
+        theDeadline.tv_nsec = theDeadline.tv_nsec + theNanoSeconds % 1000000000L;
+        if( theDeadline.tv_nsec >= 1000000000L ) {
+            theDeadline.tv_sec++;
+            theDeadline.tv_nsec = theDeadline.tv_nsec - 1000000000L;
+        }
+    }
+
+    //the words are shared between processes, so FUTEX_PRIVATE_FLAG must never be used here
+    //theDeadline is an absolute CLOCK_MONOTONIC time, nullptr waits forever
+    inline int futexWait(std::atomic<uint32_t>* theWord, const uint32_t theExpected, const timespec* theDeadline = nullptr) {
+        if( syscall(SYS_futex, theWord, FUTEX_WAIT_BITSET, theExpected, theDeadline, NULL, FUTEX_BITSET_MATCH_ANY) == -1 ) return errno;
+        else return 0;
+    }
+
+    inline int futexWake(std::atomic<uint32_t>* theWord, const int theCount = INT_MAX) {
+        if( syscall(SYS_futex, theWord, FUTEX_WAKE, theCount, NULL, NULL, 0) == -1 ) return errno;
+        else return 0;
+    }
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef _BROADCAST_RING_H_
+#define _BROADCAST_RING_H_
+
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+#include "msg_queue.h"
+#include "posix_object.h"
+#include "result.h"
+#include "shared_region.h"
+
+namespace ipclib {
+
+    //one writer publishes into a ring which every subscriber reads at its own pace through a private cursor
+    //the writer never waits for and never knows about its readers, a subscriber which falls more than a whole ring
+    //behind is overrun: it gets EOVERFLOW once, the number of lost messages is counted and it carries on from the oldest one
+    //each slot is a seqlock, so a message overwritten while it is being copied is detected instead of returned torn
+    class BroadcastRing : public PosixObject {
+        private:
+            static const uint32_t MAGIC = 0x49504252;
+            static const unsigned int SPIN_COUNT = 256;
+
+            struct Header {
+                std::atomic<uint32_t> magic;
+                uint32_t capacity;
+                uint32_t max_msg_size;
+                uint32_t slot_size;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head;
+                std::atomic<uint32_t> published;
+                std::atomic<uint32_t> waiters;
+            };
+
+            //sequence is 2 * (position + 1) once the message of position is readable and one less while it is written
+            struct Slot {
+                std::atomic<uint64_t> sequence;
+                uint32_t size;
+            };
+
+            Header* header;
+            char* slots;
+            SharedRegion region;
+            bool non_blocking;
+
+            Result deallocateResources();
+            Slot* getSlot(const uint64_t thePosition) const { return (Slot*)(slots + (size_t)(thePosition & (header->capacity - 1)) * header->slot_size); }
+            uint64_t getOldestPosition() const;
+            Result waitFor(const uint64_t theCursor, const timespec* theDeadline);
+            Result readData(uint64_t& theCursor, uint64_t& theLost, void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const timespec* theDeadline);
+
+        public:
+            class Subscriber {
+                friend class BroadcastRing;
+
+                private:
+                    BroadcastRing* ring;
+                    uint64_t cursor;
+                    uint64_t lost;
+
+                    Subscriber(BroadcastRing* theRing, const uint64_t theCursor) { ring = theRing; cursor = theCursor; lost = 0; }
+
+                public:
+                    Subscriber() { ring = nullptr; cursor = 0; lost = 0; }
+
+                    uint64_t getCursor() const { return cursor; }
+                    uint64_t getLostNumber() const { return lost; }
+                    long getPendingNumber() const;
+
+                    Result receive(std::string& theBuffer);
+                    Result receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds = 0);
+                    Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize);
+                    Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds = 0);
+
+                    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue);
+                    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+            };
+
+            BroadcastRing() : PosixObject() { header = nullptr; slots = nullptr; }
+            BroadcastRing(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 1024, const long theMaxMsgSize = 256);
+
+            long getMaxMsgSize() const { return header ? header->max_msg_size : -1; }
+            long getMaxMsg() const { return header ? header->capacity : -1; }
+            uint64_t getHead() const { return header ? header->head.load(std::memory_order_acquire) : 0; }
+            bool isNonBlocking() const { return non_blocking; }
+
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 1024, const long theMaxMsgSize = 256);
+            Result destroy();
+
+            //only one thread in one process may publish into a ring
+            Result publish(const std::string& theMsg);
+            Result publishBytes(const void* theData, const size_t theSize);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type publish(const T& theValue);
+
+            //a new subscriber sees only what is published after it, unless it asks for what is still in the ring
+            Subscriber subscribe(const bool fromOldest = false);
+
+            virtual ~BroadcastRing() { deallocateResources(); }
+    };
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type BroadcastRing::publish(const T& theValue) {
+        return publishBytes(&theValue, sizeof(T));
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type BroadcastRing::Subscriber::receive(T& theValue) {
+        size_t received;
+        Result res = receiveBytes(&theValue, sizeof(T), received);
+        if( res && received != sizeof(T) ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+        return res;
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type BroadcastRing::Subscriber::receive(T& theValue, const long theSeconds, const long theNanoSeconds) {
+        size_t received;
+        Result res = receiveBytes(&theValue, sizeof(T), received, theSeconds, theNanoSeconds);
+        if( res && received != sizeof(T) ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+        return res;
+    }
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef _BUFFER_POOL_H_
+#define _BUFFER_POOL_H_
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+#include "deadline.h"
+#include "mapping_options.h"
+#include "posix_object.h"
+#include "result.h"
+#include "shared_region.h"
+
+namespace ipclib {
+
+    //a fixed number of equally sized slots in a shared segment, handed out and given back across processes
+    //every release bumps the slot generation, so a descriptor which outlived its slot is detected instead of read
+    class BufferPool : public PosixObject {
+        public:
+            struct Descriptor {
+                uint32_t slot;
+                uint32_t generation;
+                uint64_t offset;
+                uint64_t length;
+            };
+
+            struct Buffer {
+                char* data;
+                size_t capacity;
+                uint32_t slot;
+                uint32_t generation;
+            };
+
+        private:
+            static const uint32_t MAGIC = 0x49504250;
+            static const uint32_t NO_SLOT = 0xFFFFFFFF;
+            static const unsigned int SPIN_COUNT = 256;
+
+            struct Header {
+                std::atomic<uint32_t> magic;
+                uint32_t slot_number;
+                uint64_t slot_size;
+
+                //the low half is the first free slot, the high half a tag which changes on every pop and push against ABA
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> free_head;
+                std::atomic<uint32_t> free_number;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> releases;
+                std::atomic<uint32_t> waiters;
+            };
+
+            struct SlotState {
+                std::atomic<uint32_t> generation;
+                std::atomic<uint32_t> next;
+            };
+
+            Header* header;
+            SlotState* states;
+            char* slots;
+            SharedRegion region;
+            bool non_blocking;
+
+            Result deallocateResources();
+            static size_t getStatesSize(const uint32_t theSlotNumber);
+            bool pop(uint32_t& theSlot);
+            void push(const uint32_t theSlot);
+            Result acquireBuffer(Buffer& theBuffer, const timespec* theDeadline);
+
+        public:
+            BufferPool() : PosixObject() { header = nullptr; states = nullptr; slots = nullptr; }
+            BufferPool(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theSlotNumber = 16, const long theSlotSize = 1048576, const MappingOptions& theOptions = MappingOptions());
+
+            long getSlotNumber() const { return header ? header->slot_number : -1; }
+            long getSlotSize() const { return header ? header->slot_size : -1; }
+            long getFreeNumber() const { return header ? header->free_number.load(std::memory_order_relaxed) : -1; }
+            bool isNonBlocking() const { return non_blocking; }
+            bool isOwner() const { return region.isOwner(); }
+
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theSlotNumber = 16, const long theSlotSize = 1048576, const MappingOptions& theOptions = MappingOptions());
+            Result destroy();
+
+            Result acquire(Buffer& theBuffer);
+            Result acquire(Buffer& theBuffer, const long theSeconds, const long theNanoSeconds = 0);
+            Result acquire(Buffer& theBuffer, const Deadline& theDeadline);
+            Result getDescriptor(const Buffer& theBuffer, const size_t theLength, const size_t theOffset, Descriptor& theDescriptor) const;
+            Result getData(const Descriptor& theDescriptor, const char*& theData) const;
+            Result release(const Buffer& theBuffer);
+            Result release(const Descriptor& theDescriptor);
+            Result release(const uint32_t theSlot, const uint32_t theGeneration);
+
+            virtual ~BufferPool() { deallocateResources(); }
+    };
+
+}
+
+#endif
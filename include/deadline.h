@@ -0,0 +1,45 @@
+#ifndef _DEADLINE_H_
+#define _DEADLINE_H_
+
+#include <time.h>
+
+#include "result.h"
+
+namespace ipclib {
+
+    //an absolute point in time, taken once and then handed to as many timed operations as needed
+    //a monotonic deadline is not affected by wall clock jumps wherever the underlying call accepts CLOCK_MONOTONIC
+    class Deadline {
+        public:
+            enum Clock {
+                MONOTONIC = CLOCK_MONOTONIC,
+                REALTIME = CLOCK_REALTIME
+            };
+
+            static void normalize(timespec& theTime);
+
+        private:
+            Clock clock;
+            timespec time;
+
+            //mq_timedsend and friends only know CLOCK_REALTIME, the conversion is done once and then reused
+            //so a deadline which gets converted should not be shared between threads
+            mutable timespec converted;
+            mutable bool is_converted;
+
+        public:
+            Deadline();
+            explicit Deadline(const long theSeconds, const long theNanoSeconds = 0, const Clock& theClock = MONOTONIC);
+
+            static Deadline at(const timespec& theTime, const Clock& theClock = MONOTONIC);
+
+            Clock getClock() const { return clock; }
+            const timespec& getTime() const { return time; }
+            Result getTime(const Clock& theClock, timespec& theTime) const;
+            long long getRemaining() const;
+            bool isExpired() const { return getRemaining() == 0; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+#include <stdint.h>
+
+#include "result.h"
+
+namespace ipclib {
+
+    class Event {
+        private:
+            int event_fd;
+            Result initialization_result;
+
+            Result deallocateResources();
+
+        public:
+            Event() { event_fd = -1; }
+            Event(const unsigned int theValue, const bool isNonBlocking = true, const bool isSemaphore = false);
+            Event(const Event&) = delete;
+            Event& operator=(const Event&) = delete;
+
+            int getDescriptor() const { return event_fd; }
+            Result getInitializationResult() const { return initialization_result; }
+
+            Result create(const unsigned int theValue = 0, const bool isNonBlocking = true, const bool isSemaphore = false);
+            Result signal(const uint64_t theCount = 1);
+            Result consume(uint64_t& theCount);
+            Result consume();
+
+            virtual ~Event() { deallocateResources(); }
+    };
+
+}
+
+#endif
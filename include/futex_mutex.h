@@ -0,0 +1,56 @@
+#ifndef _FUTEX_MUTEX_H_
+#define _FUTEX_MUTEX_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+#include "result.h"
+
+namespace ipclib {
+
+    //a zero filled FutexMutex is unlocked, so it can be placed directly inside a SharedMemory payload
+    class FutexMutex {
+        private:
+            static const uint32_t UNLOCKED = 0;
+            static const uint32_t LOCKED = 1;
+            static const uint32_t CONTENDED = 2;
+            static const unsigned int SPIN_COUNT = 128;
+
+            std::atomic<uint32_t> state;
+
+            Result lockSlow(const timespec* theDeadline);
+            void unlockSlow();
+
+        public:
+            FutexMutex() : state(UNLOCKED) {}
+            FutexMutex(const FutexMutex&) = delete;
+            FutexMutex& operator=(const FutexMutex&) = delete;
+
+            bool isLocked() const { return state.load(std::memory_order_relaxed) != UNLOCKED; }
+
+            bool tryLock();
+            Result lock();
+            Result lock(const long theSeconds, const long theNanoSeconds = 0);
+            Result unlock();
+    };
+
+    inline bool FutexMutex::tryLock() {
+        uint32_t expected = UNLOCKED;
+        return state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    inline Result FutexMutex::lock() {
+        if( tryLock() ) return Result(Result::SUCCESS);
+        else return lockSlow(nullptr);
+    }
+
+    inline Result FutexMutex::unlock() {
+        if( state.fetch_sub(1, std::memory_order_release) != LOCKED ) unlockSlow();
+        return Result(Result::SUCCESS);
+    }
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _FUTEX_SEMAPHORE_H_
+#define _FUTEX_SEMAPHORE_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+#include "result.h"
+
+namespace ipclib {
+
+    //a zero filled FutexSemaphore is a valid semaphore with value 0, so it can be placed directly inside a SharedMemory payload
+    class FutexSemaphore {
+        private:
+            std::atomic<uint32_t> value;
+            std::atomic<uint32_t> waiters;
+
+            Result waitSlow(const timespec* theDeadline);
+
+        public:
+            FutexSemaphore(const unsigned int theValue = 0) : value(theValue), waiters(0) {}
+            FutexSemaphore(const FutexSemaphore&) = delete;
+            FutexSemaphore& operator=(const FutexSemaphore&) = delete;
+
+            int getValue() const { return value.load(std::memory_order_relaxed); }
+
+            void initialize(const unsigned int theValue) { value.store(theValue, std::memory_order_relaxed); waiters.store(0, std::memory_order_relaxed); }
+            bool tryWait();
+            Result wait();
+            Result wait(const long theSeconds, const long theNanoSeconds = 0);
+            Result signal();
+    };
+
+    inline bool FutexSemaphore::tryWait() {
+        uint32_t current = value.load(std::memory_order_relaxed);
+        while( current > 0 ) {
+            if( value.compare_exchange_weak(current, current - 1, std::memory_order_acquire, std::memory_order_relaxed) ) return true;
+        }
+
+        return false;
+    }
+
+    inline Result FutexSemaphore::wait() {
+        if( tryWait() ) return Result(Result::SUCCESS);
+        else return waitSlow(nullptr);
+    }
+
+}
+
+#endif
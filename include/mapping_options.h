@@ -0,0 +1,67 @@
+#ifndef _MAPPING_OPTIONS_H_
+#define _MAPPING_OPTIONS_H_
+
+#include <string>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "result.h"
+
+namespace ipclib {
+
+    class MappingOptions {
+        public:
+            enum HugePages {
+                HUGE_PAGES_NONE,
+                HUGE_PAGES_TRANSPARENT,
+                HUGE_PAGES_HUGETLBFS
+            };
+
+            static const int NO_ADVICE = -1;
+            static const int NO_NUMA_NODE = -1;
+            static const int CURRENT_NUMA_NODE = -2;
+
+        private:
+            bool populate;
+            bool lock;
+            HugePages huge_pages;
+            bool huge_pages_required;
+            int advice;
+            std::string hugetlbfs_path;
+            int numa_node;
+            bool numa_node_required;
+
+            Result bindNumaNode(void* theAddress, const size_t theSize) const;
+            bool isHugetlbfsMounted() const;
+
+        public:
+            MappingOptions();
+
+            bool isPopulated() const { return populate; }
+            bool isLocked() const { return lock; }
+            HugePages getHugePages() const { return huge_pages; }
+            bool areHugePagesRequired() const { return huge_pages_required; }
+            int getAdvice() const { return advice; }
+            std::string getHugetlbfsPath() const { return hugetlbfs_path; }
+            int getNumaNode() const { return numa_node; }
+            bool isNumaNodeRequired() const { return numa_node_required; }
+
+            MappingOptions& setPopulated(const bool isPopulated) { populate = isPopulated; return *this; }
+            MappingOptions& setLocked(const bool isLocked) { lock = isLocked; return *this; }
+            MappingOptions& setHugePages(const HugePages& theHugePages, const bool areRequired = false) { huge_pages = theHugePages; huge_pages_required = areRequired; return *this; }
+            MappingOptions& setAdvice(const int theAdvice) { advice = theAdvice; return *this; }
+            MappingOptions& setHugetlbfsPath(const std::string& thePath) { hugetlbfs_path = thePath; return *this; }
+            //CURRENT_NUMA_NODE is resolved to the node of the thread which maps the segment
+            //isRequired binds the pages to the node instead of preferring it, a node mbind refuses fails create() either way
+            MappingOptions& setNumaNode(const int theNode, const bool isRequired = false) { numa_node = theNode; numa_node_required = isRequired; return *this; }
+
+            int openSegment(const std::string& thePosixName, const int theFlags, const mode_t thePermission, std::string& theFilePath) const;
+            static int unlinkSegment(const std::string& thePosixName, const std::string& theFilePath);
+            static size_t getSegmentSize(const int theDescriptor, const size_t theSize, const std::string& theFilePath);
+            int getMmapFlags() const;
+            Result apply(void* theAddress, const size_t theSize, const std::string& theFilePath) const;
+    };
+
+}
+
+#endif
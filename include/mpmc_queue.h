@@ -0,0 +1,116 @@
+#ifndef _MPMC_QUEUE_H_
+#define _MPMC_QUEUE_H_
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+#include "msg_queue.h"
+#include "posix_object.h"
+#include "result.h"
+#include "shared_region.h"
+
+namespace ipclib {
+
+    class MpmcQueue : public PosixObject {
+        private:
+            static const uint32_t MAGIC = 0x4950514d;
+            static const unsigned int SPIN_COUNT = 256;
+
+            struct Header {
+                std::atomic<uint32_t> magic;
+                uint32_t capacity;
+                uint32_t max_msg_size;
+                uint32_t slot_size;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> enqueue_position;
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dequeue_position;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> not_empty;
+                std::atomic<uint32_t> consumers_waiting;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> not_full;
+                std::atomic<uint32_t> producers_waiting;
+            };
+
+            struct Slot {
+                std::atomic<uint64_t> sequence;
+                uint32_t size;
+            };
+
+            Header* header;
+            char* slots;
+            SharedRegion region;
+            bool non_blocking;
+
+            Result deallocateResources();
+            Slot* getSlot(const uint64_t thePosition) const { return (Slot*)(slots + (size_t)(thePosition & (header->capacity - 1)) * header->slot_size); }
+            bool isFull() const;
+            bool isDrained() const;
+            Result waitFor(bool (MpmcQueue::*theCondition)() const, std::atomic<uint32_t>& theEvent, std::atomic<uint32_t>& theWaiters, const timespec* theDeadline);
+            void notify(std::atomic<uint32_t>& theEvent, std::atomic<uint32_t>& theWaiters);
+            Result sendData(const void* theData, const size_t theSize, const timespec* theDeadline);
+            Result receiveData(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const timespec* theDeadline);
+
+        public:
+            MpmcQueue() : PosixObject() { header = nullptr; slots = nullptr; }
+            MpmcQueue(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 10, const long theMaxMsgSize = 8192);
+
+            long getMaxMsgSize() const { return header ? header->max_msg_size : -1; }
+            long getMaxMsg() const { return header ? header->capacity : -1; }
+            long getMsgNumber() const;
+            bool isNonBlocking() const { return non_blocking; }
+            bool isEmpty() const { return !getMsgNumber(); }
+
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 10, const long theMaxMsgSize = 8192);
+            Result destroy();
+            Result send(const std::string& theMsg);
+            Result send(const std::string& theMsg, const long theSeconds, const long theNanoSeconds = 0);
+            Result receive(std::string& theBuffer);
+            Result receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds = 0);
+            Result sendBytes(const void* theData, const size_t theSize);
+            Result sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds = 0);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds = 0);
+
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+
+            virtual ~MpmcQueue() { deallocateResources(); }
+    };
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MpmcQueue::send(const T& theValue) {
+        return sendData(&theValue, sizeof(T), nullptr);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MpmcQueue::send(const T& theValue, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+        return sendData(&theValue, sizeof(T), &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MpmcQueue::receive(T& theValue) {
+        size_t received;
+        Result res = receiveData(&theValue, sizeof(T), received, nullptr);
+        if( res && received != sizeof(T) ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+        return res;
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MpmcQueue::receive(T& theValue, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+
+        size_t received;
+        Result res = receiveData(&theValue, sizeof(T), received, &tm);
+        if( res && received != sizeof(T) ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+        return res;
+    }
+
+}
+
+#endif
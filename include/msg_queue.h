@@ -3,12 +3,22 @@
 
 #include <mqueue.h>
 #include <string>
+#include <vector>
+#include <type_traits>
+#include <stddef.h>
 
 #include "posix_object.h"
+#include "deadline.h"
 #include "result.h"
+#include "stats.h"
+#include "trace.h"
 
 namespace ipclib {
 
+    template<class T> struct IsMsgType {
+        static const bool value = std::is_trivially_copyable<T>::value && !std::is_array<T>::value && !std::is_pointer<T>::value;
+    };
+
     class MsgQueue : public PosixObject {
         public:
             enum Protection {
@@ -17,36 +27,197 @@ namespace ipclib {
                 READ_AND_WRITE
             };
 
+            //the kernel hands out higher priorities first and keeps FIFO order within one priority
+            //POSIX guarantees at least 32 levels, Linux allows up to sysconf(_SC_MQ_PRIO_MAX) - 1
+            class Priority {
+                private:
+                    unsigned int value;
+
+                public:
+                    static const unsigned int LOWEST = 0;
+                    static const unsigned int HIGHEST = 31;
+
+                    explicit Priority(const unsigned int theValue = LOWEST) : value(theValue) {}
+
+                    unsigned int getValue() const { return value; }
+
+                    bool operator==(const Priority& thePriority) const { return value == thePriority.value; }
+                    bool operator!=(const Priority& thePriority) const { return value != thePriority.value; }
+                    bool operator<(const Priority& thePriority) const { return value < thePriority.value; }
+            };
+
         private:
             static const long ATTRIBUTE_ERROR = -1;
 
             mqd_t msg_queue;
             Protection protection;
+            mq_attr cached_attribute;
+            Metrics metrics;
 
             Result deallocateResources();
             Result getPosixAttribute(mq_attr* theAttribute);
+            Result getTimeout(const long theSeconds, const long theNanoSeconds, timespec& theTimeout);
+            Result sendData(const void* theData, const size_t theSize, const unsigned int thePriority, const timespec* theTimeout);
+            Result receiveData(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, unsigned int* thePriority, const timespec* theTimeout);
+            Result receiveValue(void* theValue, const size_t theSize, unsigned int* thePriority, const timespec* theTimeout);
+            Result receiveString(std::string& theBuffer, unsigned int* thePriority, const timespec* theTimeout);
+            int sendOne(const void* theData, const size_t theSize, const unsigned int thePriority, const bool toBlock);
+            ssize_t receiveOne(void* theBuffer, unsigned int* thePriority, const bool toBlock);
+            Result getBatchResult(const TraceOp theOp, const int theError, const size_t theCount);
 
         public:
-            MsgQueue() : PosixObject() {}
-            MsgQueue(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const Protection& theProtection = READ_AND_WRITE);
+            MsgQueue() : PosixObject() { cached_attribute.mq_msgsize = cached_attribute.mq_maxmsg = ATTRIBUTE_ERROR; }
+            MsgQueue(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const Protection& theProtection = READ_AND_WRITE, const long theMaxMsg = 0, const long theMaxMsgSize = 0);
 
             Protection getProtection() const { return protection; }
-            long getMaxMsgSize();
-            long getMaxMsg();
+            mqd_t getDescriptor() const { return msg_queue; }
+            long getMaxMsgSize() const { return cached_attribute.mq_msgsize; }
+            long getMaxMsg() const { return cached_attribute.mq_maxmsg; }
             long getMsgNumber();
             bool isNonBlocking();
             bool isEmpty() { return !getMsgNumber(); }
+            const Metrics& getMetrics() const { return metrics; }
+
+            Result enableMetrics();
+            void disableMetrics() { metrics.disable(); }
 
-            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const Protection& theProtection = READ_AND_WRITE);
+            //theMaxMsg and theMaxMsgSize only apply when the queue is actually created, 0 keeps the system default
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const Protection& theProtection = READ_AND_WRITE, const long theMaxMsg = 0, const long theMaxMsgSize = 0);
             Result destroy();
             Result send(const std::string& theMsg);
             Result send(const std::string& theMsg, const long theSeconds, const long theNanoSeconds = 0);
+            Result send(const std::string& theMsg, const Deadline& theDeadline);
+            Result send(const std::string& theMsg, const Priority& thePriority);
+            Result send(const std::string& theMsg, const Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+            Result send(const std::string& theMsg, const Priority& thePriority, const Deadline& theDeadline);
             Result receive(std::string& theBuffer);
             Result receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds = 0);
+            Result receive(std::string& theBuffer, const Deadline& theDeadline);
+            Result receive(std::string& theBuffer, Priority& thePriority);
+            Result receive(std::string& theBuffer, Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+            Result receive(std::string& theBuffer, Priority& thePriority, const Deadline& theDeadline);
+            Result sendBytes(const void* theData, const size_t theSize);
+            Result sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds = 0);
+            Result sendBytes(const void* theData, const size_t theSize, const Deadline& theDeadline);
+            Result sendBytes(const void* theData, const size_t theSize, const Priority& thePriority);
+            Result sendBytes(const void* theData, const size_t theSize, const Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+            Result sendBytes(const void* theData, const size_t theSize, const Priority& thePriority, const Deadline& theDeadline);
+            //a message longer than theBufferSize is still taken off the queue, it fails with EMSGSIZE
+            //with its first theBufferSize bytes in theBuffer and its full length in theReceivedSize
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds = 0);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const Deadline& theDeadline);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, Priority& thePriority);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, Priority& thePriority, const Deadline& theDeadline);
+            //thePriorities, when given, runs parallel to the messages of the batch
+            Result sendBatch(const std::vector<std::string>& theMsgs, size_t& theSentCount, const Priority* thePriorities = nullptr);
+            Result sendBatchBytes(const void* const* theData, const size_t* theSizes, const size_t theCount, size_t& theSentCount, const Priority* thePriorities = nullptr);
+            Result receiveBatch(std::vector<std::string>& theBuffers, const size_t theMaxCount, size_t& theReceivedCount, Priority* thePriorities = nullptr);
+            Result receiveBatchBytes(void* theBuffer, const size_t theBufferSize, size_t* theSizes, const size_t theMaxCount, size_t& theReceivedCount, Priority* thePriorities = nullptr);
+            Result drain(std::vector<std::string>& theBuffers, const size_t theMaxCount, size_t& theReceivedCount, Priority* thePriorities = nullptr);
+
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const Deadline& theDeadline);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const Priority& thePriority);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const Priority& thePriority, const Deadline& theDeadline);
+            //a message whose size is not sizeof(T) is consumed all the same and fails with EMSGSIZE
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, const Deadline& theDeadline);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, Priority& thePriority);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, Priority& thePriority, const Deadline& theDeadline);
 
             virtual ~MsgQueue() { deallocateResources(); }
     };
 
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::send(const T& theValue) {
+        return sendData(&theValue, sizeof(T), 0, nullptr);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::send(const T& theValue, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+        if( !res ) return res;
+        return sendData(&theValue, sizeof(T), 0, &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::send(const T& theValue, const Priority& thePriority) {
+        return sendData(&theValue, sizeof(T), thePriority.getValue(), nullptr);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::send(const T& theValue, const Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+        if( !res ) return res;
+        return sendData(&theValue, sizeof(T), thePriority.getValue(), &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::receive(T& theValue) {
+        return receiveValue(&theValue, sizeof(T), nullptr, nullptr);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::receive(T& theValue, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+        if( !res ) return res;
+        return receiveValue(&theValue, sizeof(T), nullptr, &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::receive(T& theValue, Priority& thePriority) {
+        unsigned int priority = 0;
+        Result res = receiveValue(&theValue, sizeof(T), &priority, nullptr);
+        thePriority = Priority(priority);
+        return res;
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::receive(T& theValue, Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+        if( !res ) return res;
+
+        unsigned int priority = 0;
+        res = receiveValue(&theValue, sizeof(T), &priority, &tm);
+        thePriority = Priority(priority);
+        return res;
+    }
+
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::send(const T& theValue, const Deadline& theDeadline) {
+        timespec tm;
+        Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+        if( !res ) return res;
+        return sendData(&theValue, sizeof(T), 0, &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::send(const T& theValue, const Priority& thePriority, const Deadline& theDeadline) {
+        timespec tm;
+        Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+        if( !res ) return res;
+        return sendData(&theValue, sizeof(T), thePriority.getValue(), &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::receive(T& theValue, const Deadline& theDeadline) {
+        timespec tm;
+        Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+        if( !res ) return res;
+        return receiveValue(&theValue, sizeof(T), nullptr, &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type MsgQueue::receive(T& theValue, Priority& thePriority, const Deadline& theDeadline) {
+        timespec tm;
+        Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+        if( !res ) return res;
+
+        unsigned int priority = 0;
+        res = receiveValue(&theValue, sizeof(T), &priority, &tm);
+        thePriority = Priority(priority);
+        return res;
+    }
+
 }
 
 #endif
@@ -0,0 +1,80 @@
+#ifndef _OFFSET_PTR_H_
+#define _OFFSET_PTR_H_
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <stdint.h>
+
+namespace ipclib {
+
+    //stores the distance from itself to the target, so it stays valid in every process that maps the segment
+    //a distance of 1 is used as null, since no aligned object can start one byte after the pointer itself
+    template<class T> class OffsetPtr {
+        private:
+            static const std::ptrdiff_t NULL_OFFSET = 1;
+
+            std::ptrdiff_t offset;
+
+            //the arithmetic goes through uintptr_t, pointer arithmetic between unrelated objects lets the optimizer assume the result points into *this
+            void set(const T* theTarget) { offset = theTarget ? (std::ptrdiff_t)((uintptr_t)(theTarget) - (uintptr_t)(this)) : NULL_OFFSET; }
+
+        public:
+            typedef T element_type;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef typename std::add_lvalue_reference<T>::type reference;
+            typedef OffsetPtr<T> pointer;
+            typedef std::random_access_iterator_tag iterator_category;
+
+            template<class U> struct rebind { typedef OffsetPtr<U> other; };
+
+            OffsetPtr() { offset = NULL_OFFSET; }
+            OffsetPtr(std::nullptr_t) { offset = NULL_OFFSET; }
+            OffsetPtr(T* theTarget) { set(theTarget); }
+            OffsetPtr(const OffsetPtr& thePointer) { set(thePointer.get()); }
+            template<class U> OffsetPtr(const OffsetPtr<U>& thePointer, typename std::enable_if<std::is_convertible<U*, T*>::value>::type* = nullptr) { set(thePointer.get()); }
+            template<class U> explicit OffsetPtr(const OffsetPtr<U>& thePointer, typename std::enable_if<!std::is_convertible<U*, T*>::value>::type* = nullptr) { set(static_cast<T*>(thePointer.get())); }
+
+            static OffsetPtr pointer_to(reference theReference) { return OffsetPtr(&theReference); }
+
+            T* get() const { return offset == NULL_OFFSET ? nullptr : (T*)((uintptr_t)(this) + offset); }
+
+            OffsetPtr& operator=(const OffsetPtr& thePointer) { set(thePointer.get()); return *this; }
+            OffsetPtr& operator=(T* theTarget) { set(theTarget); return *this; }
+            OffsetPtr& operator=(std::nullptr_t) { offset = NULL_OFFSET; return *this; }
+
+            reference operator*() const { return *get(); }
+            T* operator->() const { return get(); }
+            reference operator[](const difference_type theIndex) const { return get()[theIndex]; }
+            explicit operator bool() const { return offset != NULL_OFFSET; }
+            operator T*() const { return get(); }
+
+            OffsetPtr& operator++() { set(get() + 1); return *this; }
+            OffsetPtr operator++(int) { OffsetPtr previous(*this); set(get() + 1); return previous; }
+            OffsetPtr& operator--() { set(get() - 1); return *this; }
+            OffsetPtr operator--(int) { OffsetPtr previous(*this); set(get() - 1); return previous; }
+            OffsetPtr& operator+=(const difference_type theDistance) { set(get() + theDistance); return *this; }
+            OffsetPtr& operator-=(const difference_type theDistance) { set(get() - theDistance); return *this; }
+
+            OffsetPtr operator+(const difference_type theDistance) const { return OffsetPtr(get() + theDistance); }
+            OffsetPtr operator-(const difference_type theDistance) const { return OffsetPtr(get() - theDistance); }
+            difference_type operator-(const OffsetPtr& thePointer) const { return get() - thePointer.get(); }
+
+            bool operator==(const OffsetPtr& thePointer) const { return get() == thePointer.get(); }
+            bool operator!=(const OffsetPtr& thePointer) const { return get() != thePointer.get(); }
+            bool operator<(const OffsetPtr& thePointer) const { return get() < thePointer.get(); }
+            bool operator>(const OffsetPtr& thePointer) const { return get() > thePointer.get(); }
+            bool operator<=(const OffsetPtr& thePointer) const { return get() <= thePointer.get(); }
+            bool operator>=(const OffsetPtr& thePointer) const { return get() >= thePointer.get(); }
+            bool operator==(std::nullptr_t) const { return offset == NULL_OFFSET; }
+            bool operator!=(std::nullptr_t) const { return offset != NULL_OFFSET; }
+    };
+
+    template<class T> OffsetPtr<T> operator+(const typename OffsetPtr<T>::difference_type theDistance, const OffsetPtr<T>& thePointer) {
+        return thePointer + theDistance;
+    }
+
+}
+
+#endif
@@ -3,14 +3,19 @@
 
 #include <semaphore.h>
 
+#include "deadline.h"
 #include "posix_object.h"
 #include "result.h"
+#include "spin_policy.h"
+#include "stats.h"
 
 namespace ipclib {
 
     class Semaphore : public PosixObject {
         private:
             sem_t* sem;
+            SpinPolicy spin_policy;
+            Metrics metrics;
 
             Result deallocateResources();
 
@@ -19,11 +24,19 @@ namespace ipclib {
             Semaphore(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const unsigned int theValue = 1);
 
             int getValue();
+            const SpinPolicy& getSpinPolicy() const { return spin_policy; }
+            const Metrics& getMetrics() const { return metrics; }
+
+            void setSpinPolicy(const SpinPolicy& thePolicy) { spin_policy = thePolicy; }
+            Result enableMetrics() { return metrics.enable(STATS_SEMAPHORE, name, getValue()); }
+            void disableMetrics() { metrics.disable(); }
 
             Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const unsigned int theValue = 1);
             Result destroy();
             Result wait();
             Result wait(const long theSeconds, const long theNanoSeconds = 0);
+            Result wait(const Deadline& theDeadline);
+            Result tryWait();
             Result signal();
 
             virtual ~Semaphore() { deallocateResources(); }
@@ -0,0 +1,54 @@
+#ifndef _PRIORITY_SCHEDULER_H_
+#define _PRIORITY_SCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "msg_queue.h"
+#include "result.h"
+
+namespace ipclib {
+
+    //receives through a MsgQueue but ages what it buffers, so a steady stream of high priority messages can not starve
+    //the low ones forever: a buffered message gains one priority level every theAgingInterval deliveries
+    //messages at or above theUrgentPriority never age and always go first, that is where cancels and heartbeats belong
+    //only buffered messages age: with theMaxBuffered below the queue's mq_maxmsg the kernel keeps handing over the
+    //highest priorities first, so low priority messages which never make it into the buffer can still starve
+    class PriorityScheduler {
+        private:
+            struct Entry {
+                std::string msg;
+                uint64_t sequence;
+            };
+
+            MsgQueue* queue;
+            unsigned int aging_interval;
+            unsigned int urgent_priority;
+            size_t max_buffered;
+            size_t buffered;
+            uint64_t delivered;
+            std::map< unsigned int, std::deque<Entry> > bands;
+            std::vector<std::string> batch;
+            std::vector<std::string> spare;
+            std::vector<MsgQueue::Priority> batch_priorities;
+
+            Result refill();
+            void pop(std::string& theMsg, MsgQueue::Priority& thePriority);
+
+        public:
+            PriorityScheduler(MsgQueue& theQueue, const unsigned int theAgingInterval = 8, const MsgQueue::Priority& theUrgentPriority = MsgQueue::Priority(MsgQueue::Priority::HIGHEST), const size_t theMaxBuffered = 64);
+
+            size_t getBufferedNumber() const { return buffered; }
+            unsigned int getAgingInterval() const { return aging_interval; }
+
+            Result receive(std::string& theMsg, MsgQueue::Priority& thePriority);
+            Result receive(std::string& theMsg, MsgQueue::Priority& thePriority, const long theSeconds, const long theNanoSeconds = 0);
+    };
+
+}
+
+#endif
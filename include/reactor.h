@@ -0,0 +1,66 @@
+#ifndef _REACTOR_H_
+#define _REACTOR_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#include "event.h"
+#include "msg_queue.h"
+#include "result.h"
+
+namespace ipclib {
+
+    //dispatches readiness of many descriptors from a single thread
+    //handlers, add() and remove() run on the loop thread, stop() may be called from anywhere
+    class Reactor {
+        public:
+            enum Interest {
+                READABLE = EPOLLIN,
+                WRITABLE = EPOLLOUT,
+                READABLE_AND_WRITABLE = EPOLLIN | EPOLLOUT
+            };
+
+            typedef std::function<void(const uint32_t theEvents)> Handler;
+
+        private:
+            static const int MAX_EVENTS = 64;
+
+            int epoll_fd;
+            Event wakeup;
+            std::atomic<bool> stopped;
+            std::map< int, std::shared_ptr<Handler> > handlers;
+            epoll_event events[MAX_EVENTS];
+            Result initialization_result;
+
+            Result deallocateResources();
+
+        public:
+            Reactor();
+            Reactor(const Reactor&) = delete;
+            Reactor& operator=(const Reactor&) = delete;
+
+            Result getInitializationResult() const { return initialization_result; }
+            size_t getHandlerNumber() const { return handlers.size(); }
+
+            Result add(const int theDescriptor, const Handler& theHandler, const uint32_t theInterest = READABLE);
+            Result add(MsgQueue& theQueue, const Handler& theHandler, const uint32_t theInterest = READABLE);
+            Result add(Event& theEvent, const Handler& theHandler);
+            Result modify(const int theDescriptor, const uint32_t theInterest);
+            Result remove(const int theDescriptor);
+            Result remove(MsgQueue& theQueue) { return remove(theQueue.getDescriptor()); }
+            Result remove(Event& theEvent) { return remove(theEvent.getDescriptor()); }
+
+            Result runOnce(const int theTimeout = -1);
+            Result run();
+            Result stop();
+
+            virtual ~Reactor() { deallocateResources(); }
+    };
+
+}
+
+#endif
@@ -2,30 +2,45 @@
 #define _RESULT_H_
 
 #include <string>
+#include <type_traits>
 
 namespace ipclib {
 
+    //an error code plus an optional static message, trivially copyable so that returning one never allocates
+    //positive codes are errno values, negative ones are ipclib specific
     class Result {
+        public:
+            enum Category {
+                CATEGORY_NONE,
+                CATEGORY_SYSTEM,
+                CATEGORY_IPCLIB
+            };
+
+            static const int SUCCESS = 0;
+
         private:
             int error;
-            std::string description;
+            const char* message;
 
         public:
-            static const int SUCCESS = 0;
-
-            Result(const int theError = SUCCESS, const std::string& theDescription = "");
+            //theMessage must outlive every copy of the Result, string literals are the intended use
+            Result(const int theError = SUCCESS, const char* theMessage = nullptr) : error(theError), message(theMessage) {}
 
             int getError() const { return error; }
-            std::string getDescription() const { return description; }
+            Category getCategory() const { return error == SUCCESS ? CATEGORY_NONE : (error > 0 ? CATEGORY_SYSTEM : CATEGORY_IPCLIB); }
+            //only built here, the hot paths never pay for formatting the error
+            std::string getDescription() const;
             bool isSuccesful() const { return !error; }
 
-            void set(const int theError, const std::string& theDescription) { error = theError; description = theDescription; }
+            void set(const int theError, const char* theMessage = nullptr) { error = theError; message = theMessage; }
             void setError(const int theError) { error = theError; }
-            void setDescription(const std::string& theDescription) { description = theDescription; }
+            void setDescription(const char* theMessage) { message = theMessage; }
 
             operator bool() const { return isSuccesful(); }
     };
 
+    static_assert(std::is_trivially_copyable<Result>::value, "Result must stay trivially copyable");
+
 }
 
 #endif
@@ -0,0 +1,139 @@
+#ifndef _RPC_H_
+#define _RPC_H_
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+#include "deadline.h"
+#include "futex_mutex.h"
+#include "msg_queue.h"
+#include "result.h"
+#include "thread.h"
+#include "thread_pool.h"
+
+namespace ipclib {
+
+    //every request and reply starts with this header, the payload follows it in the same message
+    //a header without a client only wakes the reader up, one without a correlation id tells the server the client closed
+    struct RpcHeader {
+        uint64_t correlation_id;
+        uint64_t client;
+        uint32_t method;
+        int32_t status;
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    struct RpcReply {
+        Result result;
+        std::string payload;
+    };
+
+    //reads requests from the queue named after the service and runs their handlers on a ThreadPool
+    //replies go to the queue of the client which sent the request, so clients never see each other's traffic
+    class RpcServer {
+        public:
+            typedef std::function<Result(const std::string& theRequest, std::string& theReply)> Handler;
+
+            static const long REPLY_TIMEOUT = 1;
+            //header and payload together fit the default /proc/sys/fs/mqueue/msgsize_max of 8192
+            static const long DEFAULT_MAX_PAYLOAD_SIZE = 8192 - (long)(sizeof(RpcHeader));
+
+        private:
+            std::string name;
+            MsgQueue requests;
+            ThreadPool* pool;
+            std::map<uint32_t, Handler> handlers;
+            FutexMutex reply_lock;
+            std::map< uint64_t, std::shared_ptr<MsgQueue> > reply_queues;
+            std::atomic<bool> stopped;
+            Result initialization_result;
+
+            std::shared_ptr<MsgQueue> getReplyQueue(const uint64_t theClient);
+            void dropReplyQueue(const uint64_t theClient, const std::shared_ptr<MsgQueue>& theQueue);
+            void reply(const RpcHeader& theHeader, const Result& theResult, const std::string& thePayload);
+            void dispatch(const RpcHeader& theHeader, const std::string& theRequest);
+
+        public:
+            RpcServer(ThreadPool& thePool) : stopped(false) { pool = &thePool; }
+            RpcServer(ThreadPool& thePool, const std::string& theName, const long theMaxMsg = 0, const long theMaxPayloadSize = DEFAULT_MAX_PAYLOAD_SIZE);
+            RpcServer(const RpcServer&) = delete;
+            RpcServer& operator=(const RpcServer&) = delete;
+
+            Result getInitializationResult() const { return initialization_result; }
+            long getMaxPayloadSize() const { return requests.getMaxMsgSize() - sizeof(RpcHeader); }
+
+            Result create(const std::string& theName, const long theMaxMsg = 0, const long theMaxPayloadSize = DEFAULT_MAX_PAYLOAD_SIZE);
+            Result destroy() { return requests.destroy(); }
+
+            //handlers are registered before run() and are called concurrently from the pool's workers
+            //a handler which throws is answered with ECANCELED, a request the pool refuses with the error of post()
+            void setHandler(const uint32_t theMethod, const Handler& theHandler) { handlers[theMethod] = theHandler; }
+
+            Result run();
+            Result stop();
+    };
+
+    //sends requests without waiting for the previous replies, a background thread matches replies to their futures
+    //call() pipelines, the synchronous overload honours its timeout exactly, while a pipelined future whose deadline
+    //passes is completed with ETIMEDOUT by the background thread within EXPIRY_INTERVAL
+    class RpcClient {
+        public:
+            static const long EXPIRY_INTERVAL = 10000000;
+            static const long CLOSE_TIMEOUT = 1;
+
+        private:
+            struct Pending {
+                std::promise<RpcReply> promise;
+                std::multimap<long long, uint64_t>::iterator expiry;
+            };
+
+            uint64_t client;
+            MsgQueue requests;
+            MsgQueue replies;
+            Thread receiver;
+            std::atomic<bool> receiver_running;
+            //cleared under lock by the receiver when it exits, no request registered after that could ever complete
+            bool receiving;
+            std::atomic<bool> stopping;
+            std::atomic<uint64_t> next_id;
+            FutexMutex lock;
+            std::map<uint64_t, Pending> pending;
+            std::multimap<long long, uint64_t> expiries;
+            Result initialization_result;
+
+            static void* receiverMain(void* theClient);
+            void receiveReplies();
+            void complete(const uint64_t theId, const RpcReply& theReply);
+            void expire();
+            Result send(const uint32_t theMethod, const std::string& theRequest, const Deadline& theDeadline, const bool toExpire, std::future<RpcReply>& theFuture, uint64_t& theId);
+
+        public:
+            RpcClient() : receiver_running(false), stopping(false), next_id(1) { client = 0; receiving = false; }
+            RpcClient(const std::string& theName, const long theMaxMsg = 0);
+            RpcClient(const RpcClient&) = delete;
+            RpcClient& operator=(const RpcClient&) = delete;
+
+            static std::string getReplyQueueName(const std::string& theName, const uint64_t theClient);
+
+            Result getInitializationResult() const { return initialization_result; }
+            long getMaxPayloadSize() const { return requests.getMaxMsgSize() - sizeof(RpcHeader); }
+            size_t getPendingNumber();
+
+            Result create(const std::string& theName, const long theMaxMsg = 0);
+            Result close();
+
+            std::future<RpcReply> call(const uint32_t theMethod, const std::string& theRequest, const long theSeconds, const long theNanoSeconds = 0);
+            Result call(const uint32_t theMethod, const std::string& theRequest, std::string& theReply, const long theSeconds, const long theNanoSeconds = 0);
+
+            virtual ~RpcClient() { close(); }
+    };
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef _SHARED_ARENA_H_
+#define _SHARED_ARENA_H_
+
+#include <atomic>
+#include <new>
+#include <string>
+#include <utility>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "atomic_wait.h"
+#include "posix_object.h"
+#include "result.h"
+#include "shared_region.h"
+
+namespace ipclib {
+
+    class SharedArena : public PosixObject {
+        public:
+            static const unsigned int SIZE_CLASSES = 36;
+            //every block follows a 16 byte Block header, so this is all the alignment an allocation gets
+            static const size_t ALIGNMENT = 16;
+
+            struct Header {
+                std::atomic<uint32_t> magic;
+                uint32_t reserved;
+                uint64_t size;
+                std::atomic<uint64_t> root;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> top;
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> free_lists[SIZE_CLASSES];
+            };
+
+            static void* allocate(Header* theHeader, const size_t theSize);
+            static void deallocate(Header* theHeader, void* theAddress);
+
+        private:
+            static const uint32_t MAGIC = 0x49504141;
+            static const unsigned int MIN_CLASS = 5;
+            static const uint64_t OFFSET_MASK = (1ULL << 40) - 1;
+
+            struct Block {
+                uint32_t size_class;
+                uint32_t magic;
+                uint64_t next;
+            };
+
+            Header* header;
+            SharedRegion region;
+
+            Result deallocateResources();
+
+        public:
+            SharedArena() : PosixObject() { header = nullptr; }
+            SharedArena(const std::string& theName, const size_t theSize, const bool toCreate = true, const bool toCreateExclusively = false, const MappingOptions& theOptions = MappingOptions());
+
+            Header* getHeader() const { return header; }
+            size_t getSize() const { return header ? header->size : 0; }
+            size_t getUsed() const { return header ? header->top.load(std::memory_order_relaxed) : 0; }
+            bool isOwner() const { return region.isOwner(); }
+
+            void* allocate(const size_t theSize) { return header ? allocate(header, theSize) : nullptr; }
+            void deallocate(void* theAddress) { if( header ) deallocate(header, theAddress); }
+            template<class T, class... Args> T* construct(Args&&... theArguments);
+            template<class T> void destruct(T* theObject);
+
+            void* getRoot() const;
+            template<class T> T* getRoot() const { return (T*)(getRoot()); }
+            void setRoot(void* theRoot);
+
+            Result create(const std::string& theName, const size_t theSize, const bool toCreate = true, const bool toCreateExclusively = false, const MappingOptions& theOptions = MappingOptions());
+            Result destroy();
+
+            virtual ~SharedArena() { deallocateResources(); }
+    };
+
+    template<class T, class... Args> T* SharedArena::construct(Args&&... theArguments) {
+        static_assert(alignof(T) <= ALIGNMENT, "SharedArena blocks are only 16 byte aligned");
+        void* address = allocate(sizeof(T));
+        if( !address ) return nullptr;
+        return new (address) T(std::forward<Args>(theArguments)...);
+    }
+
+    template<class T> void SharedArena::destruct(T* theObject) {
+        if( !theObject ) return;
+        theObject->~T();
+        deallocate(theObject);
+    }
+
+}
+
+#endif
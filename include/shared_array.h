@@ -0,0 +1,69 @@
+#ifndef _SHARED_ARRAY_H_
+#define _SHARED_ARRAY_H_
+
+#include <string>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+
+#include "shared_region.h"
+#include "result.h"
+
+namespace ipclib {
+
+    template<class T> class SharedArray : private SharedRegion {
+        public:
+            typedef SharedRegion::Protection Protection;
+            using SharedRegion::READ_ONLY;
+            using SharedRegion::WRITE_ONLY;
+            using SharedRegion::READ_AND_WRITE;
+
+            typedef T value_type;
+            typedef T* iterator;
+            typedef const T* const_iterator;
+
+            SharedArray() : SharedRegion() {}
+            SharedArray(const std::string& theName, const size_t theCount, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions());
+
+            using SharedRegion::isAlreadyInitialized;
+            using SharedRegion::getName;
+            using SharedRegion::getInitializationResult;
+            using SharedRegion::getProtection;
+            using SharedRegion::isOwner;
+            using SharedRegion::isHugetlbfsBacked;
+            using SharedRegion::destroy;
+
+            size_t size() const { return getSize() / sizeof(T); }
+            bool empty() const { return size() == 0; }
+            T* data() const { return (T*)(getAddress()); }
+            iterator begin() const { return data(); }
+            iterator end() const { return data() + size(); }
+
+            T& operator[](const size_t theIndex) const { return data()[theIndex]; }
+            T& getValue(const size_t theIndex) const { return data()[theIndex]; }
+
+            void setValue(const size_t theIndex, const T& theValue) { data()[theIndex] = theValue; }
+
+            Result create(const std::string& theName, const size_t theCount, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions());
+    };
+
+    template<class T> SharedArray<T>::SharedArray(const std::string& theName, const size_t theCount, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection, const MappingOptions& theOptions) : SharedRegion() {
+        create(theName, theCount, toCreate, toCreateExclusively, theProtection, theOptions);
+    }
+
+    template<class T> Result SharedArray<T>::create(const std::string& theName, const size_t theCount, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection, const MappingOptions& theOptions) {
+        Result res = SharedRegion::create(theName, theCount * sizeof(T), toCreate, toCreateExclusively, theProtection, theOptions);
+        //a rejected region is not left mapped, size() and data() of the array must not reach it
+        if( res && !isHugetlbfsBacked() && getSize() % sizeof(T) != 0 ) {
+            if( isOwner() ) SharedRegion::destroy();
+            deallocateResources();
+            initialization_result = Result(EINVAL, "Shared region size is not a multiple of the element size");
+            return initialization_result;
+        }
+
+        return res;
+    }
+
+}
+
+#endif
@@ -0,0 +1,463 @@
+#ifndef _SHARED_HASH_MAP_H_
+#define _SHARED_HASH_MAP_H_
+
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "atomic_wait.h"
+#include "futex_mutex.h"
+#include "mapping_options.h"
+#include "posix_object.h"
+#include "result.h"
+#include "shared_region.h"
+
+namespace ipclib {
+
+    //std::hash is free to differ between builds, the map is shared between processes so it hashes the bytes itself
+    template<class K> struct SharedHashMapHash {
+        uint64_t operator()(const K& theKey) const {
+            const unsigned char* bytes = (const unsigned char*)(&theKey);
+
+            uint64_t hash = 14695981039346656037ULL;
+            for( size_t i = 0; i < sizeof(K); i++ ) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            return hash ^ (hash >> 32);
+        }
+    };
+
+    //an open addressing table with linear probing, laid out in a shared segment and never resized
+    //lookups take no lock, every bucket is a seqlock and a reader only retries the bucket a write overlapped
+    //writers of the same key serialize on one of STRIPE_NUMBER futex mutexes, different keys only meet on a bucket claim
+    //erased keys leave tombstones, once too few empty buckets are left the table is compacted under every stripe
+    //keys are compared bytewise, so they must not contain padding
+    template<class K, class V, class Hash = SharedHashMapHash<K> > class SharedHashMap : public PosixObject {
+        static_assert(std::is_trivially_copyable<K>::value, "SharedHashMap requires a trivially copyable key");
+        static_assert(std::is_trivially_copyable<V>::value, "SharedHashMap requires a trivially copyable value");
+
+        public:
+            static const unsigned int STRIPE_NUMBER = 64;
+
+        private:
+            static const uint32_t MAGIC = 0x49504853;
+
+            enum State {
+                EMPTY = 0,
+                CLAIMED,
+                FULL,
+                DELETED
+            };
+
+            struct Header {
+                std::atomic<uint32_t> magic;
+                uint32_t key_size;
+                uint32_t value_size;
+                uint32_t reserved;
+                uint64_t capacity;
+                uint64_t max_size;
+                uint64_t max_used;
+
+                //odd while a compaction moves the keys around, lookups wait for it and retry if one overlapped them
+                std::atomic<uint32_t> generation;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> size;
+                std::atomic<uint64_t> used;
+            };
+
+            struct Stripe {
+                alignas(CACHE_LINE_SIZE) FutexMutex lock;
+            };
+
+            struct Bucket {
+                std::atomic<uint32_t> sequence;
+                std::atomic<uint32_t> state;
+                K key;
+                V value;
+            };
+
+            Header* header;
+            Stripe* stripes;
+            Bucket* buckets;
+            SharedRegion region;
+            Hash hash;
+
+            Result deallocateResources();
+            static size_t getSegmentSize(const uint64_t theCapacity) { return sizeof(Header) + STRIPE_NUMBER * sizeof(Stripe) + theCapacity * sizeof(Bucket); }
+            Bucket& getBucket(const uint64_t theIndex) const { return buckets[theIndex & (header->capacity - 1)]; }
+            FutexMutex& getLock(const uint64_t theHash) const { return stripes[(theHash >> 32) % STRIPE_NUMBER].lock; }
+            void readBucket(const Bucket& theBucket, uint32_t& theState, K& theKey, V* theValue) const;
+            static void writeBucket(Bucket& theBucket, const uint32_t theState, const K* theKey, const V* theValue);
+            static bool isEqual(const K& theFirst, const K& theSecond) { return memcmp(&theFirst, &theSecond, sizeof(K)) == 0; }
+            uint32_t beginLookup() const;
+            bool endLookup(const uint32_t theGeneration) const;
+            bool lookup(const K& theKey, V* theValue) const;
+            Result rebuild(const bool isForced);
+
+        public:
+            SharedHashMap() : PosixObject() { header = nullptr; stripes = nullptr; buckets = nullptr; }
+            SharedHashMap(const std::string& theName, const size_t theMaxSize = 1024, const double theMaxLoadFactor = 0.5, const bool toCreate = true, const bool toCreateExclusively = false, const MappingOptions& theOptions = MappingOptions());
+
+            size_t getSize() const { return header ? header->size.load(std::memory_order_relaxed) : 0; }
+            size_t getCapacity() const { return header ? header->capacity : 0; }
+            size_t getMaxSize() const { return header ? header->max_size : 0; }
+            double getLoadFactor() const { return header ? (double)(header->used.load(std::memory_order_relaxed)) / header->capacity : 0; }
+            bool isEmpty() const { return getSize() == 0; }
+            bool isOwner() const { return region.isOwner(); }
+
+            //theMaxSize keys fit in a table sized so that its load factor never goes above theMaxLoadFactor
+            Result create(const std::string& theName, const size_t theMaxSize = 1024, const double theMaxLoadFactor = 0.5, const bool toCreate = true, const bool toCreateExclusively = false, const MappingOptions& theOptions = MappingOptions());
+            Result destroy() { return region.destroy(); }
+
+            bool find(const K& theKey, V& theValue) const;
+            bool contains(const K& theKey) const;
+            Result insert(const K& theKey, const V& theValue);
+            Result erase(const K& theKey);
+
+            //drops every tombstone, inserts already do it on their own whenever they run out of empty buckets
+            Result compact() { return rebuild(true); }
+
+            virtual ~SharedHashMap() { deallocateResources(); }
+    };
+
+    template<class K, class V, class Hash> SharedHashMap<K, V, Hash>::SharedHashMap(const std::string& theName, const size_t theMaxSize, const double theMaxLoadFactor, const bool toCreate, const bool toCreateExclusively, const MappingOptions& theOptions) : PosixObject() {
+        header = nullptr;
+        stripes = nullptr;
+        buckets = nullptr;
+        create(theName, theMaxSize, theMaxLoadFactor, toCreate, toCreateExclusively, theOptions);
+    }
+
+    template<class K, class V, class Hash> Result SharedHashMap<K, V, Hash>::create(const std::string& theName, const size_t theMaxSize, const double theMaxLoadFactor, const bool toCreate, const bool toCreateExclusively, const MappingOptions& theOptions) {
+        if( already_initialized ) deallocateResources();
+
+        PosixObject::create(theName);
+
+        if( theMaxSize == 0 || theMaxSize > (1ULL << 40) || !(theMaxLoadFactor > 0) || theMaxLoadFactor > 1 ) {
+            initialization_result = Result(EINVAL);
+            return initialization_result;
+        }
+
+        //a full table would make every miss probe all of it, so one bucket is always left empty
+        uint64_t capacity = 2;
+        while( capacity * theMaxLoadFactor < theMaxSize || capacity <= theMaxSize ) capacity = capacity << 1;
+
+        //live keys and tombstones together fill the table up to the load factor, past that it is compacted
+        uint64_t max_used = (uint64_t)(capacity * theMaxLoadFactor);
+        if( max_used > capacity - 1 ) max_used = capacity - 1;
+        if( max_used < theMaxSize ) max_used = theMaxSize;
+
+        //only the process which actually creates the segment lays out the header, everyone else waits for the magic number
+        Result res = region.create(theName, getSegmentSize(capacity), toCreate, toCreateExclusively, SharedRegion::READ_AND_WRITE, theOptions);
+        if( !res ) {
+            initialization_result = res;
+            return initialization_result;
+        }
+
+        header = (Header*)(region.getAddress());
+        stripes = (Stripe*)(region.getData() + sizeof(Header));
+        buckets = (Bucket*)(region.getData() + sizeof(Header) + STRIPE_NUMBER * sizeof(Stripe));
+
+        //the segment comes zero filled, which already is an unlocked stripe and an empty bucket
+        if( region.isOwner() ) {
+            header->key_size = sizeof(K);
+            header->value_size = sizeof(V);
+            header->capacity = capacity;
+            header->max_size = theMaxSize;
+            header->max_used = max_used;
+            header->generation.store(0, std::memory_order_relaxed);
+            header->size.store(0, std::memory_order_relaxed);
+            header->used.store(0, std::memory_order_relaxed);
+            header->magic.store(MAGIC, std::memory_order_release);
+        }
+
+        else {
+            int attempts = 0;
+            while( region.getSize() >= sizeof(Header) && header->magic.load(std::memory_order_acquire) != MAGIC && attempts++ < 1000 ) usleep(100);
+
+            if( region.getSize() < sizeof(Header) || header->magic.load(std::memory_order_acquire) != MAGIC || getSegmentSize(header->capacity) > region.getSize() ) {
+                deallocateResources();
+                initialization_result = Result(EAGAIN, "Map is still being initialized");
+                return initialization_result;
+            }
+
+            if( header->key_size != sizeof(K) || header->value_size != sizeof(V) ) {
+                deallocateResources();
+                initialization_result = Result(EINVAL, "Map was created with different key or value types");
+                return initialization_result;
+            }
+        }
+
+        initialization_result = Result(Result::SUCCESS);
+        return initialization_result;
+    }
+
+    template<class K, class V, class Hash> Result SharedHashMap<K, V, Hash>::deallocateResources() {
+        header = nullptr;
+        stripes = nullptr;
+        buckets = nullptr;
+        return Result(Result::SUCCESS);
+    }
+
+    //theValue is only copied out when asked for, a miss or a probe past a foreign key reads just the state and the key
+    template<class K, class V, class Hash> void SharedHashMap<K, V, Hash>::readBucket(const Bucket& theBucket, uint32_t& theState, K& theKey, V* theValue) const {
+        while( true ) {
+            uint32_t before = theBucket.sequence.load(std::memory_order_acquire);
+            if( before & 1 ) {
+                cpuRelax();
+                continue;
+            }
+
+            theState = theBucket.state.load(std::memory_order_relaxed);
+            if( theState == EMPTY ) return;
+
+            memcpy(&theKey, &theBucket.key, sizeof(K));
+            if( theValue ) memcpy(theValue, &theBucket.value, sizeof(V));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if( theBucket.sequence.load(std::memory_order_relaxed) == before ) return;
+        }
+    }
+
+    template<class K, class V, class Hash> void SharedHashMap<K, V, Hash>::writeBucket(Bucket& theBucket, const uint32_t theState, const K* theKey, const V* theValue) {
+        //a tombstone can be claimed for another key while its eraser still closes the write, that one has to finish first
+        uint32_t sequence = theBucket.sequence.load(std::memory_order_acquire);
+        while( sequence & 1 ) {
+            cpuRelax();
+            sequence = theBucket.sequence.load(std::memory_order_acquire);
+        }
+
+        theBucket.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if( theKey ) memcpy(&theBucket.key, theKey, sizeof(K));
+        if( theValue ) memcpy(&theBucket.value, theValue, sizeof(V));
+        theBucket.state.store(theState, std::memory_order_relaxed);
+
+        theBucket.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    //a lookup which overlapped a rebuild may have missed a key that was being moved, so it only trusts an unchanged generation
+    template<class K, class V, class Hash> uint32_t SharedHashMap<K, V, Hash>::beginLookup() const {
+        uint32_t generation = header->generation.load(std::memory_order_acquire);
+        while( generation & 1 ) {
+            futexWait(&header->generation, generation);
+            generation = header->generation.load(std::memory_order_acquire);
+        }
+
+        return generation;
+    }
+
+    template<class K, class V, class Hash> bool SharedHashMap<K, V, Hash>::endLookup(const uint32_t theGeneration) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header->generation.load(std::memory_order_relaxed) == theGeneration;
+    }
+
+    template<class K, class V, class Hash> bool SharedHashMap<K, V, Hash>::lookup(const K& theKey, V* theValue) const {
+        uint64_t index = hash(theKey);
+
+        while( true ) {
+            uint32_t generation = beginLookup();
+
+            bool found = false;
+            V value;
+            for( uint64_t i = 0; i < header->capacity; i++ ) {
+                uint32_t state;
+                K key;
+                readBucket(getBucket(index + i), state, key, theValue ? &value : nullptr);
+
+                if( state == EMPTY ) break;
+                if( state == FULL && isEqual(key, theKey) ) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if( endLookup(generation) ) {
+                if( found && theValue ) *theValue = value;
+                return found;
+            }
+        }
+    }
+
+    template<class K, class V, class Hash> bool SharedHashMap<K, V, Hash>::find(const K& theKey, V& theValue) const {
+        if( !header ) return false;
+        else return lookup(theKey, &theValue);
+    }
+
+    template<class K, class V, class Hash> bool SharedHashMap<K, V, Hash>::contains(const K& theKey) const {
+        if( !header ) return false;
+        else return lookup(theKey, nullptr);
+    }
+
+    //inserts theKey or overwrites its value, ENOSPC once the map already holds the theMaxSize keys given at create()
+    template<class K, class V, class Hash> Result SharedHashMap<K, V, Hash>::insert(const K& theKey, const V& theValue) {
+        if( !header ) return Result(EBADF);
+
+        uint64_t index = hash(theKey);
+        FutexMutex& lock = getLock(index);
+
+        for( int attempt = 0; attempt < 2; attempt++ ) {
+            Result res = lock.lock();
+            if( !res ) return res;
+
+            //the whole chain is walked before anything is claimed, theKey may sit past a deleted bucket
+            Bucket* reusable = nullptr;
+            uint64_t i = 0;
+            for( ; i < header->capacity; i++ ) {
+                Bucket& bucket = getBucket(index + i);
+
+                uint32_t state;
+                K key;
+                readBucket(bucket, state, key, nullptr);
+
+                if( state == FULL && isEqual(key, theKey) ) {
+                    writeBucket(bucket, FULL, nullptr, &theValue);
+                    lock.unlock();
+                    return Result(Result::SUCCESS);
+                }
+
+                if( state == DELETED && !reusable ) reusable = &bucket;
+                if( state == EMPTY ) break;
+            }
+
+            //only live keys count against the limit, tombstones just cost probing until they are compacted away
+            if( header->size.fetch_add(1, std::memory_order_relaxed) >= header->max_size ) {
+                header->size.fetch_sub(1, std::memory_order_relaxed);
+                lock.unlock();
+                return Result(ENOSPC, "Map is full");
+            }
+
+            //writers of other keys probe the same buckets, so a bucket is only taken by whoever wins its state
+            uint32_t expected = DELETED;
+            if( reusable && reusable->state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire) ) {
+                writeBucket(*reusable, FULL, &theKey, &theValue);
+                lock.unlock();
+                return Result(Result::SUCCESS);
+            }
+
+            //the bucket which ended the walk may have been claimed for another key meanwhile, probing then simply goes on
+            for( ; i < header->capacity; i++ ) {
+                Bucket& bucket = getBucket(index + i);
+
+                expected = bucket.state.load(std::memory_order_relaxed);
+                if( expected == DELETED && bucket.state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire) ) {
+                    writeBucket(bucket, FULL, &theKey, &theValue);
+                    lock.unlock();
+                    return Result(Result::SUCCESS);
+                }
+
+                if( expected != EMPTY ) continue;
+
+                if( header->used.fetch_add(1, std::memory_order_relaxed) >= header->max_used ) {
+                    header->used.fetch_sub(1, std::memory_order_relaxed);
+                    break;
+                }
+
+                if( bucket.state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire) ) {
+                    writeBucket(bucket, FULL, &theKey, &theValue);
+                    lock.unlock();
+                    return Result(Result::SUCCESS);
+                }
+
+                header->used.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            //too many tombstones to take another empty bucket, the table is compacted and the insert starts over
+            header->size.fetch_sub(1, std::memory_order_relaxed);
+            lock.unlock();
+
+            if( attempt == 0 ) {
+                res = rebuild(false);
+                if( !res ) return res;
+            }
+        }
+
+        return Result(ENOSPC, "Map is full");
+    }
+
+    //the bucket becomes a tombstone so lookups keep probing past it, a later insert of any key or compact() reclaims it
+    template<class K, class V, class Hash> Result SharedHashMap<K, V, Hash>::erase(const K& theKey) {
+        if( !header ) return Result(EBADF);
+
+        uint64_t index = hash(theKey);
+        FutexMutex& lock = getLock(index);
+        Result res = lock.lock();
+        if( !res ) return res;
+
+        for( uint64_t i = 0; i < header->capacity; i++ ) {
+            Bucket& bucket = getBucket(index + i);
+
+            uint32_t state;
+            K key;
+            readBucket(bucket, state, key, nullptr);
+
+            if( state == EMPTY ) break;
+            if( state == FULL && isEqual(key, theKey) ) {
+                writeBucket(bucket, DELETED, nullptr, nullptr);
+                header->size.fetch_sub(1, std::memory_order_relaxed);
+                lock.unlock();
+                return Result(Result::SUCCESS);
+            }
+        }
+
+        lock.unlock();
+        return Result(ENOENT);
+    }
+
+    //every stripe is held so no writer runs, lookups wait for the odd generation to pass and then probe the new layout
+    //insert only rebuilds once the tombstones leave no empty bucket to claim, isForced rebuilds anyway
+    template<class K, class V, class Hash> Result SharedHashMap<K, V, Hash>::rebuild(const bool isForced) {
+        if( !header ) return Result(EBADF);
+
+        Result res;
+        unsigned int locked = 0;
+        for( ; locked < STRIPE_NUMBER; locked++ ) {
+            res = stripes[locked].lock.lock();
+            if( !res ) break;
+        }
+
+        if( res && (isForced || header->used.load(std::memory_order_relaxed) >= header->max_used) ) {
+            struct Entry {
+                K key;
+                V value;
+            };
+
+            std::vector<Entry> entries;
+            entries.reserve(header->size.load(std::memory_order_relaxed));
+            for( uint64_t i = 0; i < header->capacity; i++ ) {
+                if( buckets[i].state.load(std::memory_order_relaxed) != FULL ) continue;
+
+                entries.push_back(Entry());
+                memcpy(&entries.back().key, &buckets[i].key, sizeof(K));
+                memcpy(&entries.back().value, &buckets[i].value, sizeof(V));
+            }
+
+            header->generation.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for( uint64_t i = 0; i < header->capacity; i++ ) {
+                if( buckets[i].state.load(std::memory_order_relaxed) != EMPTY ) writeBucket(buckets[i], EMPTY, nullptr, nullptr);
+            }
+
+            for( size_t i = 0; i < entries.size(); i++ ) {
+                uint64_t index = hash(entries[i].key);
+                while( getBucket(index).state.load(std::memory_order_relaxed) != EMPTY ) index++;
+                writeBucket(getBucket(index), FULL, &entries[i].key, &entries[i].value);
+            }
+
+            header->used.store(entries.size(), std::memory_order_relaxed);
+            header->generation.fetch_add(1, std::memory_order_release);
+            futexWake(&header->generation);
+        }
+
+        while( locked > 0 ) stripes[--locked].lock.unlock();
+        return res;
+    }
+
+}
+
+#endif
@@ -7,11 +7,10 @@
 #include <unistd.h>
 #include <sys/types.h>
 
+#include "mapping_options.h"
 #include "posix_object.h"
-
-#ifdef NDEBUG
-#include <iostream>
-#endif
+#include "stats.h"
+#include "trace.h"
 
 namespace ipclib {
 
@@ -26,59 +25,57 @@ namespace ipclib {
         private:
             T* obj_address;
             Protection protection;
+            size_t mapping_size;
+            std::string file_path;
+            Metrics metrics;
 
             Result deallocateResources();
 
         public:
-            SharedMemory() : PosixObject() { obj_address = nullptr; }
-            SharedMemory(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE);
+            SharedMemory() : PosixObject() { obj_address = nullptr; mapping_size = 0; }
+            SharedMemory(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions());
 
             Protection getProtection() const { return protection; }
-            T& getValue() const { return *obj_address; }
+            bool isHugetlbfsBacked() const { return !file_path.empty(); }
+            //with metrics enabled every getValue() counts as a read of the whole object
+            T& getValue() const { metrics.onOperation(sizeof(T)); return *obj_address; }
+            const Metrics& getMetrics() const { return metrics; }
 
-            void setValue(const T& theValue) { *obj_address = theValue; }
+            void setValue(const T& theValue) { metrics.onOperation(sizeof(T)); *obj_address = theValue; }
+            Result enableMetrics() { return metrics.enable(STATS_SHARED_MEMORY, name); }
+            void disableMetrics() { metrics.disable(); }
 
-            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE);
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions());
             Result destroy();
 
             virtual ~SharedMemory() { deallocateResources(); }
     };
 
-    template<class T> SharedMemory<T>::SharedMemory(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection): PosixObject() {
-        create(theName, toCreate, toCreateExclusively, theProtection);
+    template<class T> SharedMemory<T>::SharedMemory(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection, const MappingOptions& theOptions): PosixObject() {
+        obj_address = nullptr;
+        mapping_size = 0;
+        create(theName, toCreate, toCreateExclusively, theProtection, theOptions);
     }
 
 
     template<class T> Result SharedMemory<T>::deallocateResources() {
-        #ifdef NDEBUG
-        std::cout << "IPCLIB: deallocating resources for " << name << "...";
-        #endif
-
-        if( munmap(obj_address, sizeof(T)) == 0 ) {
-            #ifdef NDEBUG
-            std::cout << "SUCCESS\n";
-            #endif
+        if( munmap(obj_address, mapping_size) == 0 ) {
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CLOSE, name, 0, 0);
             return Result(Result::SUCCESS);
         }
 
         else {
-            Result res(errno, strerror(errno));
-            #ifdef NDEBUG
-            std::cout << "FAILED with error " << res.getError() << "\n";
-            #endif
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CLOSE, name, res.getError(), 0);
             return res;
         }
     }
 
-    template <class T> Result SharedMemory<T>::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection) {
+    template <class T> Result SharedMemory<T>::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection, const MappingOptions& theOptions) {
         if( already_initialized ) deallocateResources();
 
         PosixObject::create(theName);
 
-        #ifdef NDEBUG
-        std::cout << "IPCLIB: starting initialization for " << name << "...";
-        #endif
-
         int oflag;
         protection = theProtection;
         if( theProtection == READ_ONLY ) oflag = O_RDONLY;
@@ -88,71 +85,67 @@ namespace ipclib {
         if( toCreateExclusively ) oflag = oflag | O_EXCL;
 
         int fd;
-        if( (fd = shm_open(posix_name.c_str(), oflag, DEFAULT_PERMISSION)) < 0 ) {
-            Result res(errno, strerror(errno));
-            #ifdef NDEBUG
-            std::cout << "FAILED with error " << res.getError() << "\n";
-            #endif
+        if( (fd = theOptions.openSegment(posix_name, oflag, DEFAULT_PERMISSION, file_path)) < 0 ) {
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CREATE, name, res.getError(), 0);
             initialization_result = res;
             return initialization_result;
         }
 
-        if( ftruncate(fd, sizeof(T)) == -1 ) {
-            Result res(errno, strerror(errno));
-            #ifdef NDEBUG
-            std::cout << "FAILED with error " << res.getError() << "\n";
-            #endif
+        mapping_size = MappingOptions::getSegmentSize(fd, sizeof(T), file_path);
+
+        //a read only descriptor can not be resized, readers rely on the writer having sized the segment
+        if( theProtection != READ_ONLY && ftruncate(fd, mapping_size) == -1 ) {
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CREATE, name, res.getError(), 0);
             initialization_result = res;
             return initialization_result;
         }
 
         int prot;
         if( theProtection == READ_ONLY ) prot = PROT_READ;
-        if( theProtection == WRITE_ONLY ) prot = PROT_WRITE;
+        else if( theProtection == WRITE_ONLY ) prot = PROT_WRITE;
         else prot = PROT_READ | PROT_WRITE;
 
-        if( (obj_address = (T*)(mmap(NULL, sizeof(T), prot, MAP_SHARED, fd, 0))) == MAP_FAILED ) {
-            Result res(errno, strerror(errno));
-            #ifdef NDEBUG
-            std::cout << "FAILED with error " << res.getError() << "\n";
-            #endif
+        if( (obj_address = (T*)(mmap(NULL, mapping_size, prot, theOptions.getMmapFlags(), fd, 0))) == MAP_FAILED ) {
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CREATE, name, res.getError(), 0);
             initialization_result = res;
             return initialization_result;
         }
 
         if( close(fd) == -1 ) {
-            Result res(errno, strerror(errno));
-            #ifdef NDEBUG
-            std::cout << "FAILED with error " << res.getError() << "\n";
-            #endif
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CREATE, name, res.getError(), 0);
+            initialization_result = res;
+            return initialization_result;
+        }
+
+        //a mapping which did not get the options it asked for is not kept half set up
+        Result res = theOptions.apply(obj_address, mapping_size, file_path);
+        if( !res ) {
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CREATE, name, res.getError(), 0);
+            munmap(obj_address, mapping_size);
+            obj_address = nullptr;
+            mapping_size = 0;
             initialization_result = res;
             return initialization_result;
         }
 
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_CREATE, name, 0, 0);
         initialization_result = Result(Result::SUCCESS);
         return initialization_result;
     }
 
     template<class T> Result SharedMemory<T>::destroy() {
-        #ifdef NDEBUG
-        std::cout << "IPCLIB: destroying shared memory " << name << "...";
-        #endif
-
-        if( shm_unlink(posix_name.c_str()) == 0 ) {
-            #ifdef NDEBUG
-            std::cout << "SUCCESS\n";
-            #endif
+        if( MappingOptions::unlinkSegment(posix_name, file_path) == 0 ) {
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_DESTROY, name, 0, 0);
             return Result(Result::SUCCESS);
         }
 
         else {
-            Result res(errno, strerror(errno));
-            #ifdef NDEBUG
-            std::cout << "FAILED with error " << res.getError() << "\n";
-            #endif
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_MEMORY_DESTROY, name, res.getError(), 0);
             return res;
         }
     }
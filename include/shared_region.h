@@ -0,0 +1,53 @@
+#ifndef _SHARED_REGION_H_
+#define _SHARED_REGION_H_
+
+#include <string>
+#include <stddef.h>
+
+#include "mapping_options.h"
+#include "posix_object.h"
+#include "result.h"
+
+namespace ipclib {
+
+    class SharedRegion : public PosixObject {
+        public:
+            enum Protection {
+                READ_ONLY,
+                WRITE_ONLY,
+                READ_AND_WRITE
+            };
+
+        private:
+            static const int SIZE_POLL_ATTEMPTS = 1000;
+            static const int SIZE_POLL_INTERVAL = 100;
+
+            void* address;
+            size_t size;
+            Protection protection;
+            bool owner;
+            std::string file_path;
+
+        protected:
+            Result deallocateResources();
+
+        public:
+            SharedRegion() : PosixObject() { address = nullptr; size = 0; owner = false; }
+            SharedRegion(const std::string& theName, const size_t theSize, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions());
+
+            Protection getProtection() const { return protection; }
+            void* getAddress() const { return address; }
+            char* getData() const { return (char*)(address); }
+            size_t getSize() const { return size; }
+            bool isOwner() const { return owner; }
+            bool isHugetlbfsBacked() const { return !file_path.empty(); }
+
+            Result create(const std::string& theName, const size_t theSize, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions());
+            Result destroy();
+
+            virtual ~SharedRegion() { deallocateResources(); }
+    };
+
+}
+
+#endif
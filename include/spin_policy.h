@@ -0,0 +1,59 @@
+#ifndef _SPIN_POLICY_H_
+#define _SPIN_POLICY_H_
+
+#include <atomic>
+#include <time.h>
+
+#include "atomic_wait.h"
+
+namespace ipclib {
+
+    class SpinPolicy {
+        private:
+            static const unsigned int CLOCK_CHECK_INTERVAL = 16;
+
+            long max_spin;
+            bool adaptive;
+            std::atomic<long> budget;
+
+            static long now();
+            void adapt(const long theTarget);
+            void onSpinSuccess(const long theElapsed);
+            void onBlocked(const long theElapsed);
+
+        public:
+            SpinPolicy(const long theMaxSpinNanoSeconds = 0, const bool isAdaptive = false);
+            SpinPolicy(const SpinPolicy& thePolicy);
+            SpinPolicy& operator=(const SpinPolicy& thePolicy);
+
+            long getMaxSpin() const { return max_spin; }
+            bool isAdaptive() const { return adaptive; }
+            long getBudget() const { return budget.load(std::memory_order_relaxed); }
+
+            template<class Condition> bool spin(Condition theCondition);
+            long startBlocking() const { return adaptive ? now() : 0; }
+            void stopBlocking(const long theStart);
+    };
+
+    template<class Condition> bool SpinPolicy::spin(Condition theCondition) {
+        long spin_budget = getBudget();
+        if( spin_budget <= 0 ) return false;
+
+        long start = now();
+        long elapsed = 0;
+        for( unsigned int i = 1; elapsed < spin_budget; i++ ) {
+            if( theCondition() ) {
+                onSpinSuccess(now() - start);
+                return true;
+            }
+
+            cpuRelax();
+            if( i % CLOCK_CHECK_INTERVAL == 0 ) elapsed = now() - start;
+        }
+
+        return false;
+    }
+
+}
+
+#endif
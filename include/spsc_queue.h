@@ -0,0 +1,107 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+#include "msg_queue.h"
+#include "posix_object.h"
+#include "result.h"
+#include "shared_region.h"
+
+namespace ipclib {
+
+    class SpscQueue : public PosixObject {
+        private:
+            static const uint32_t MAGIC = 0x49505351;
+            static const unsigned int SPIN_COUNT = 256;
+
+            struct Header {
+                std::atomic<uint32_t> magic;
+                uint32_t capacity;
+                uint32_t max_msg_size;
+                uint32_t slot_size;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head;
+                std::atomic<uint32_t> consumer_waiting;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail;
+                std::atomic<uint32_t> producer_waiting;
+            };
+
+            Header* header;
+            char* slots;
+            SharedRegion region;
+            bool non_blocking;
+            uint32_t cached_head;
+            uint32_t cached_tail;
+
+            Result deallocateResources();
+            Result waitFor(std::atomic<uint32_t>& theCounter, std::atomic<uint32_t>& theWaitingFlag, const uint32_t theValue, const timespec* theDeadline);
+            char* getSlot(const uint32_t theIndex) const { return slots + (size_t)(theIndex & (header->capacity - 1)) * header->slot_size; }
+            Result sendData(const void* theData, const size_t theSize, const timespec* theDeadline);
+            Result receiveData(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const timespec* theDeadline);
+
+        public:
+            SpscQueue() : PosixObject() { header = nullptr; slots = nullptr; }
+            SpscQueue(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 10, const long theMaxMsgSize = 8192);
+
+            long getMaxMsgSize() const { return header ? header->max_msg_size : -1; }
+            long getMaxMsg() const { return header ? header->capacity : -1; }
+            long getMsgNumber() const;
+            bool isNonBlocking() const { return non_blocking; }
+            bool isEmpty() const { return !getMsgNumber(); }
+
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 10, const long theMaxMsgSize = 8192);
+            Result destroy();
+            Result send(const std::string& theMsg);
+            Result send(const std::string& theMsg, const long theSeconds, const long theNanoSeconds = 0);
+            Result receive(std::string& theBuffer);
+            Result receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds = 0);
+            Result sendBytes(const void* theData, const size_t theSize);
+            Result sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds = 0);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize);
+            Result receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds = 0);
+
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type send(const T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue);
+            template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type receive(T& theValue, const long theSeconds, const long theNanoSeconds = 0);
+
+            virtual ~SpscQueue() { deallocateResources(); }
+    };
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type SpscQueue::send(const T& theValue) {
+        return sendData(&theValue, sizeof(T), nullptr);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type SpscQueue::send(const T& theValue, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+        return sendData(&theValue, sizeof(T), &tm);
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type SpscQueue::receive(T& theValue) {
+        size_t received;
+        Result res = receiveData(&theValue, sizeof(T), received, nullptr);
+        if( res && received != sizeof(T) ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+        return res;
+    }
+
+    template<class T> typename std::enable_if<IsMsgType<T>::value, Result>::type SpscQueue::receive(T& theValue, const long theSeconds, const long theNanoSeconds) {
+        timespec tm;
+        getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+
+        size_t received;
+        Result res = receiveData(&theValue, sizeof(T), received, &tm);
+        if( res && received != sizeof(T) ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+        return res;
+    }
+
+}
+
+#endif
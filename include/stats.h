@@ -0,0 +1,130 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "atomic_wait.h"
+#include "result.h"
+
+namespace ipclib {
+
+    enum StatsKind {
+        STATS_NONE,
+        STATS_MSG_QUEUE,
+        STATS_SEMAPHORE,
+        STATS_SHARED_MEMORY
+    };
+
+    //every process of the same user which enables metrics on an object with the same kind and name shares one slot,
+    //the identity and the counters sit on separate cache lines so updates never touch the line readers search through
+    struct StatsSlot {
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> kind;
+        std::atomic<uint32_t> users;
+        char name[56];
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> operations;
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> timeouts;
+        std::atomic<uint64_t> would_block;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> blocked_ns;
+        std::atomic<int64_t> depth;
+        std::atomic<int64_t> depth_high_water;
+    };
+
+    static_assert(sizeof(StatsSlot) == 2 * CACHE_LINE_SIZE, "a stats slot must be exactly two cache lines");
+
+    static const uint32_t STATS_SLOT_NUMBER = 1024;
+
+    //a plain copy of a slot, as read by getStats()
+    struct StatsSnapshot {
+        StatsKind kind;
+        uint32_t users;
+        std::string name;
+        uint64_t operations;
+        uint64_t bytes;
+        uint64_t timeouts;
+        uint64_t would_block;
+        uint64_t errors;
+        uint64_t blocked_ns;
+        int64_t depth;
+        int64_t depth_high_water;
+    };
+
+    const char* getStatsKindName(const StatsKind theKind);
+    std::string getStatsSegmentName(const uid_t theUser);
+    Result getStats(const uid_t theUser, std::vector<StatsSnapshot>& theSnapshots);
+
+    //metrics are off until enable() is called, and then every update is a relaxed atomic on the slot
+    //a forked child does not hold the slots of its parent, its copies stay silent until it enables them again
+    class Metrics {
+        private:
+            static std::atomic<uint32_t> process_generation;
+
+            StatsSlot* slot;
+            uint32_t generation;
+
+            static long now();
+            static void onFork();
+            StatsSlot* getSlot() const { return slot && generation == process_generation.load(std::memory_order_relaxed) ? slot : nullptr; }
+
+        public:
+            Metrics() { slot = nullptr; generation = 0; }
+            //a copy never owns the slot of the original, otherwise both would release it
+            Metrics(const Metrics&) { slot = nullptr; generation = 0; }
+            Metrics& operator=(const Metrics&) { return *this; }
+
+            bool isEnabled() const { return getSlot() != nullptr; }
+
+            //theDepth is what the object already holds, the slot starts counting from there
+            Result enable(const StatsKind theKind, const std::string& theName, const int64_t theDepth = 0);
+            void disable();
+
+            void onOperation(const size_t theBytes = 0, const uint64_t theCount = 1) const;
+            void onError(const int theError) const;
+            void onDepthChange(const int64_t theDelta) const;
+            long startBlocking() const { return getSlot() ? now() : 0; }
+            void stopBlocking(const long theStart) const;
+
+            ~Metrics() { disable(); }
+    };
+
+    inline void Metrics::onOperation(const size_t theBytes, const uint64_t theCount) const {
+        StatsSlot* current = getSlot();
+        if( !current ) return;
+        current->operations.fetch_add(theCount, std::memory_order_relaxed);
+        if( theBytes ) current->bytes.fetch_add(theBytes, std::memory_order_relaxed);
+    }
+
+    inline void Metrics::onError(const int theError) const {
+        StatsSlot* current = getSlot();
+        if( !current ) return;
+        if( theError == ETIMEDOUT ) current->timeouts.fetch_add(1, std::memory_order_relaxed);
+        else if( theError == EAGAIN ) current->would_block.fetch_add(1, std::memory_order_relaxed);
+        else current->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //the depth is only as accurate as the set of processes which enabled metrics on the object
+    inline void Metrics::onDepthChange(const int64_t theDelta) const {
+        StatsSlot* current = getSlot();
+        if( !current ) return;
+
+        int64_t depth = current->depth.fetch_add(theDelta, std::memory_order_relaxed) + theDelta;
+        int64_t high_water = current->depth_high_water.load(std::memory_order_relaxed);
+        while( depth > high_water && !current->depth_high_water.compare_exchange_weak(high_water, depth, std::memory_order_relaxed) );
+    }
+
+    inline void Metrics::stopBlocking(const long theStart) const {
+        StatsSlot* current = getSlot();
+        if( current ) current->blocked_ns.fetch_add(now() - theStart, std::memory_order_relaxed);
+    }
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <pthread.h>
 
 #include "result.h"
+#include "thread_options.h"
 
 namespace ipclib {
 
@@ -14,7 +15,10 @@ namespace ipclib {
         public:
             Thread() {}
 
-            Result run(void* theFunction(void*), void* theParameter = nullptr);
+            static int getCurrentCpu();
+            static int getCurrentNumaNode();
+
+            Result run(void* theFunction(void*), void* theParameter = nullptr, const ThreadOptions& theOptions = ThreadOptions());
             Result join(void** theReturnValue = nullptr);
             Result cancel();
     };
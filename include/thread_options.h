@@ -0,0 +1,45 @@
+#ifndef _THREAD_OPTIONS_H_
+#define _THREAD_OPTIONS_H_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <stddef.h>
+
+#include "result.h"
+
+namespace ipclib {
+
+    class ThreadOptions {
+        private:
+            std::vector<int> cpus;
+            int policy;
+            int priority;
+            size_t stack_size;
+            std::string thread_name;
+
+        public:
+            ThreadOptions();
+
+            std::vector<int> getCpus() const { return cpus; }
+            int getPolicy() const { return policy; }
+            int getPriority() const { return priority; }
+            size_t getStackSize() const { return stack_size; }
+            std::string getName() const { return thread_name; }
+
+            ThreadOptions& setCpus(const std::vector<int>& theCpus) { cpus = theCpus; return *this; }
+            ThreadOptions& addCpu(const int theCpu) { cpus.push_back(theCpu); return *this; }
+            //SCHED_FIFO and SCHED_RR need CAP_SYS_NICE or a matching RLIMIT_RTPRIO
+            ThreadOptions& setScheduling(const int thePolicy, const int thePriority = 0) { policy = thePolicy; priority = thePriority; return *this; }
+            ThreadOptions& setStackSize(const size_t theStackSize) { stack_size = theStackSize; return *this; }
+            //the kernel keeps only the first 15 characters
+            ThreadOptions& setName(const std::string& theName) { thread_name = theName; return *this; }
+
+            bool isDefault() const { return cpus.empty() && policy == SCHED_OTHER && priority == 0 && stack_size == 0; }
+            Result getAttributes(pthread_attr_t& theAttributes) const;
+            Result applyName(const pthread_t theThread) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+#include "atomic_wait.h"
+#include "futex_mutex.h"
+#include "result.h"
+#include "thread.h"
+
+namespace ipclib {
+
+    //every worker owns a deque: it pushes and pops at the back, idle workers steal from the front of the others
+    //a task submitted from a worker stays on that worker, and workers only sleep on a futex once every deque is empty
+    class ThreadPool {
+        public:
+            typedef std::function<void()> Task;
+            typedef std::function<void(std::exception_ptr)> ExceptionHandler;
+
+        private:
+            static const unsigned int SPIN_COUNT = 128;
+
+            struct Worker {
+                FutexMutex lock;
+                std::deque<Task> tasks;
+                Thread thread;
+                ThreadPool* pool;
+                unsigned int index;
+                char padding[CACHE_LINE_SIZE];
+            };
+
+            std::vector< std::unique_ptr<Worker> > workers;
+            alignas(CACHE_LINE_SIZE) std::atomic<size_t> pending;
+            alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> sleep_event;
+            std::atomic<uint32_t> sleepers;
+            std::atomic<bool> stopping;
+            std::atomic<unsigned int> posting;
+            std::atomic<unsigned int> next_worker;
+            std::atomic<size_t> failed;
+            ExceptionHandler exception_handler;
+
+            static void* workerMain(void* theWorker);
+
+            bool popTask(Worker& theWorker, Task& theTask);
+            bool stealTask(const unsigned int theThief, Task& theTask);
+            void park();
+            void push(Worker& theWorker, Task&& theTask);
+            void runTask(Task& theTask);
+
+        public:
+            ThreadPool() : pending(0), sleep_event(0), sleepers(0), stopping(false), posting(0), next_worker(0), failed(0) {}
+            ThreadPool(const unsigned int theThreadNumber);
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            size_t getThreadNumber() const { return workers.size(); }
+            size_t getPendingNumber() const { return pending.load(std::memory_order_relaxed); }
+            size_t getFailedNumber() const { return failed.load(std::memory_order_relaxed); }
+
+            //called on the worker with whatever a posted task threw, it has to be set before start()
+            //without one the exception is only counted and traced, tasks run through submit() hand theirs to the future
+            void setExceptionHandler(const ExceptionHandler& theHandler) { exception_handler = theHandler; }
+
+            Result start(const unsigned int theThreadNumber = 0);
+            //posts racing with stop() either get their task queued before the workers drain, or fail with ESRCH
+            //a worker can not join itself, so stop() from one of the pool's tasks fails with EDEADLK
+            //and the pool must never be destroyed from one of its own tasks
+            Result stop();
+            Result post(Task theTask);
+            template<class Function> auto submit(Function theFunction) -> std::future<decltype(theFunction())>;
+
+            virtual ~ThreadPool() { stop(); }
+    };
+
+    template<class Function> auto ThreadPool::submit(Function theFunction) -> std::future<decltype(theFunction())> {
+        typedef decltype(theFunction()) ReturnType;
+
+        std::shared_ptr< std::packaged_task<ReturnType()> > task = std::make_shared< std::packaged_task<ReturnType()> >(std::move(theFunction));
+        std::future<ReturnType> future = task->get_future();
+
+        Result res = post([task]() { (*task)(); });
+        if( !res ) {
+            std::promise<ReturnType> failed;
+            failed.set_exception(std::make_exception_ptr(std::runtime_error(res.getDescription())));
+            return failed.get_future();
+        }
+
+        return future;
+    }
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "result.h"
+
+//building with -DIPCLIB_TRACE records every traced operation, without it IPCLIB_TRACE expands to nothing
+//and its arguments are never evaluated
+#ifdef IPCLIB_TRACE
+#define IPCLIB_TRACE_EVENT(theOp, theObject, theError, theSize) ::ipclib::traceEvent(theOp, theObject, theError, theSize)
+#else
+#define IPCLIB_TRACE_EVENT(theOp, theObject, theError, theSize) ((void)(0))
+#endif
+
+namespace ipclib {
+
+    enum TraceOp {
+        TRACE_MSG_QUEUE_CREATE,
+        TRACE_MSG_QUEUE_CLOSE,
+        TRACE_MSG_QUEUE_GET_ATTRIBUTE,
+        TRACE_MSG_QUEUE_DESTROY,
+        TRACE_MSG_QUEUE_SEND,
+        TRACE_MSG_QUEUE_RECEIVE,
+        TRACE_MSG_QUEUE_SEND_BATCH,
+        TRACE_MSG_QUEUE_RECEIVE_BATCH,
+        TRACE_MSG_QUEUE_DRAIN,
+        TRACE_SEMAPHORE_CREATE,
+        TRACE_SEMAPHORE_CLOSE,
+        TRACE_SEMAPHORE_WAIT,
+        TRACE_SEMAPHORE_TIMED_WAIT,
+        TRACE_SEMAPHORE_SIGNAL,
+        TRACE_SEMAPHORE_GET_VALUE,
+        TRACE_SEMAPHORE_DESTROY,
+        TRACE_SHARED_MEMORY_CREATE,
+        TRACE_SHARED_MEMORY_CLOSE,
+        TRACE_SHARED_MEMORY_DESTROY,
+        TRACE_SHARED_REGION_CREATE,
+        TRACE_SHARED_REGION_CLOSE,
+        TRACE_SHARED_REGION_DESTROY,
+        TRACE_SHARED_ARENA_CREATE,
+        TRACE_SPSC_QUEUE_CREATE,
+        TRACE_MPMC_QUEUE_CREATE,
+        TRACE_BUFFER_POOL_CREATE,
+        TRACE_BROADCAST_RING_CREATE,
+        TRACE_EVENT_CREATE,
+        TRACE_REACTOR_CREATE,
+        TRACE_REACTOR_RUN,
+        TRACE_THREAD_RUN,
+        TRACE_THREAD_JOIN,
+        TRACE_THREAD_CANCEL,
+        TRACE_THREAD_POOL_START,
+        TRACE_THREAD_POOL_STOP,
+        TRACE_THREAD_POOL_TASK_FAILED,
+        TRACE_OP_NUMBER
+    };
+
+    //one cache line per event, the object name is truncated and always NUL terminated
+    struct TraceEvent {
+        uint64_t timestamp;
+        uint32_t thread;
+        uint16_t op;
+        uint16_t reserved;
+        int32_t error;
+        uint32_t size;
+        char object[40];
+    };
+
+    static_assert(sizeof(TraceEvent) == 64, "trace events must stay one cache line long");
+
+    static const uint32_t TRACE_RING_NUMBER = 64;
+    static const uint32_t TRACE_RING_SIZE = 1024;
+
+    const char* getTraceOpName(const uint16_t theOp);
+    std::string getTraceSegmentName(const pid_t theProcess);
+
+    //every thread writes into a ring of its own inside the /ipclib_trace.<pid> segment, which another process can read
+    void traceEvent(const TraceOp theOp, const char* theObject, const int theError, const size_t theSize);
+    inline void traceEvent(const TraceOp theOp, const std::string& theObject, const int theError, const size_t theSize) { traceEvent(theOp, theObject.c_str(), theError, theSize); }
+
+    //collects the events still held by the rings of theProcess, oldest first
+    Result readTrace(const pid_t theProcess, std::vector<TraceEvent>& theEvents, uint64_t& theDroppedNumber);
+
+}
+
+#endif
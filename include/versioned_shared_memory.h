@@ -0,0 +1,87 @@
+#ifndef _VERSIONED_SHARED_MEMORY_H_
+#define _VERSIONED_SHARED_MEMORY_H_
+
+#include <atomic>
+#include <type_traits>
+#include <stdint.h>
+#include <string.h>
+
+#include "atomic_wait.h"
+#include "shared_memory.h"
+
+namespace ipclib {
+
+    //a seqlock around a single value: one writer publishes, readers copy and retry only if a write overlapped the copy
+    //readers never store to the segment, so they can map it READ_ONLY and do not bounce cache lines between each other
+    template<class T> struct VersionedPayload {
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> sequence;
+        alignas(CACHE_LINE_SIZE) T value;
+    };
+
+    template<class T> class VersionedSharedMemory : private SharedMemory< VersionedPayload<T> > {
+        static_assert(std::is_trivially_copyable<T>::value, "VersionedSharedMemory requires a trivially copyable type");
+
+        private:
+            typedef SharedMemory< VersionedPayload<T> > Memory;
+
+        public:
+            typedef typename Memory::Protection Protection;
+            using Memory::READ_ONLY;
+            using Memory::WRITE_ONLY;
+            using Memory::READ_AND_WRITE;
+
+            VersionedSharedMemory() : Memory() {}
+            VersionedSharedMemory(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const Protection& theProtection = READ_AND_WRITE, const MappingOptions& theOptions = MappingOptions()) : Memory(theName, toCreate, toCreateExclusively, theProtection, theOptions) {}
+
+            using Memory::isAlreadyInitialized;
+            using Memory::getName;
+            using Memory::getInitializationResult;
+            using Memory::getProtection;
+            using Memory::isHugetlbfsBacked;
+            using Memory::create;
+            using Memory::destroy;
+
+            uint32_t getVersion() const { return Memory::getValue().sequence.load(std::memory_order_acquire) >> 1; }
+            T getValue() const { T value; getValue(value); return value; }
+
+            void getValue(T& theValue) const;
+            bool tryGetValue(T& theValue) const;
+            void setValue(const T& theValue);
+            template<class Function> void update(Function theFunction);
+    };
+
+    template<class T> bool VersionedSharedMemory<T>::tryGetValue(T& theValue) const {
+        VersionedPayload<T>& payload = Memory::getValue();
+
+        uint32_t before = payload.sequence.load(std::memory_order_acquire);
+        if( before & 1 ) return false;
+
+        memcpy(&theValue, &payload.value, sizeof(T));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return payload.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    template<class T> void VersionedSharedMemory<T>::getValue(T& theValue) const {
+        while( !tryGetValue(theValue) ) cpuRelax();
+    }
+
+    template<class T> template<class Function> void VersionedSharedMemory<T>::update(Function theFunction) {
+        VersionedPayload<T>& payload = Memory::getValue();
+
+        uint32_t sequence = payload.sequence.load(std::memory_order_relaxed);
+        payload.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        theFunction(payload.value);
+
+        payload.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    template<class T> void VersionedSharedMemory<T>::setValue(const T& theValue) {
+        update([&theValue](T& theTarget) { memcpy(&theTarget, &theValue, sizeof(T)); });
+    }
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef _ZERO_COPY_QUEUE_H_
+#define _ZERO_COPY_QUEUE_H_
+
+#include <string>
+#include <stddef.h>
+
+#include "buffer_pool.h"
+#include "msg_queue.h"
+#include "result.h"
+
+namespace ipclib {
+
+    //payloads are written once into a BufferPool slot and only their descriptor goes through the message queue,
+    //so the size of a message is bounded by the slot size instead of mq_msgsize
+    //the receiver reads the payload in place and has to release the view once it is done with it
+    class ZeroCopyQueue {
+        public:
+            typedef BufferPool::Buffer Buffer;
+
+            struct View {
+                const char* data;
+                size_t size;
+                BufferPool::Descriptor descriptor;
+            };
+
+        private:
+            MsgQueue queue;
+            BufferPool pool;
+
+            Result getView(const BufferPool::Descriptor& theDescriptor, View& theView);
+
+        public:
+            ZeroCopyQueue() {}
+            ZeroCopyQueue(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 0, const long theSlotNumber = 16, const long theSlotSize = 1048576);
+
+            Result getInitializationResult() const { return !queue.getInitializationResult() ? queue.getInitializationResult() : pool.getInitializationResult(); }
+            MsgQueue& getQueue() { return queue; }
+            BufferPool& getPool() { return pool; }
+            long getMaxPayloadSize() const { return pool.getSlotSize(); }
+
+            Result create(const std::string& theName, const bool toCreate = true, const bool toCreateExclusively = false, const bool isNonBlocking = false, const long theMaxMsg = 0, const long theSlotNumber = 16, const long theSlotSize = 1048576);
+            Result destroy();
+
+            Result acquire(Buffer& theBuffer) { return pool.acquire(theBuffer); }
+            Result acquire(Buffer& theBuffer, const long theSeconds, const long theNanoSeconds = 0) { return pool.acquire(theBuffer, theSeconds, theNanoSeconds); }
+            Result send(const Buffer& theBuffer, const size_t theLength, const size_t theOffset = 0);
+            Result send(const Buffer& theBuffer, const size_t theLength, const size_t theOffset, const long theSeconds, const long theNanoSeconds = 0);
+            Result sendBytes(const void* theData, const size_t theSize);
+            Result sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds = 0);
+            Result receive(View& theView);
+            Result receive(View& theView, const long theSeconds, const long theNanoSeconds = 0);
+            Result release(const Buffer& theBuffer) { return pool.release(theBuffer); }
+            Result release(const View& theView) { return pool.release(theView.descriptor); }
+    };
+
+}
+
+#endif
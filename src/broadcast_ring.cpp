@@ -0,0 +1,248 @@
+#include "broadcast_ring.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::BroadcastRing::BroadcastRing(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theMaxMsgSize) : PosixObject() {
+    header = nullptr;
+    slots = nullptr;
+    create(theName, toCreate, toCreateExclusively, isNonBlocking, theMaxMsg, theMaxMsgSize);
+}
+
+ipclib::Result ipclib::BroadcastRing::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theMaxMsgSize) {
+    if( already_initialized ) deallocateResources();
+
+    PosixObject::create(theName);
+
+    non_blocking = isNonBlocking;
+
+    if( theMaxMsg <= 0 || theMaxMsg > (1L << 30) || theMaxMsgSize <= 0 || theMaxMsgSize > (1L << 30) ) {
+        Result res(EINVAL);
+        IPCLIB_TRACE_EVENT(TRACE_BROADCAST_RING_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    uint32_t capacity = 1;
+    while( capacity < (uint32_t)(theMaxMsg) ) capacity = capacity << 1;
+    uint32_t slot_size = ((sizeof(Slot) + theMaxMsgSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+
+    //only the process which actually creates the segment lays out the header, everyone else waits for the magic number
+    Result res = region.create(theName, sizeof(Header) + (size_t)(capacity) * slot_size, toCreate, toCreateExclusively);
+    if( !res ) {
+        IPCLIB_TRACE_EVENT(TRACE_BROADCAST_RING_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    bool owner = region.isOwner();
+    header = (Header*)(region.getAddress());
+    slots = region.getData() + sizeof(Header);
+
+    if( owner ) {
+        header->capacity = capacity;
+        header->max_msg_size = theMaxMsgSize;
+        header->slot_size = slot_size;
+        header->head.store(0, std::memory_order_relaxed);
+        header->published.store(0, std::memory_order_relaxed);
+        header->waiters.store(0, std::memory_order_relaxed);
+        for( uint64_t i = 0; i < capacity; i++ ) getSlot(i)->sequence.store(0, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    else {
+        int attempts = 0;
+        while( region.getSize() >= sizeof(Header) && header->magic.load(std::memory_order_acquire) != MAGIC && attempts++ < 1000 ) usleep(100);
+
+        if( region.getSize() < sizeof(Header) || header->magic.load(std::memory_order_acquire) != MAGIC || sizeof(Header) + (size_t)(header->capacity) * header->slot_size > region.getSize() ) {
+            res = Result(EAGAIN, "Ring is still being initialized");
+            IPCLIB_TRACE_EVENT(TRACE_BROADCAST_RING_CREATE, name, res.getError(), 0);
+            deallocateResources();
+            initialization_result = res;
+            return initialization_result;
+        }
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_BROADCAST_RING_CREATE, name, 0, 0);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::BroadcastRing::deallocateResources() {
+    header = nullptr;
+    slots = nullptr;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BroadcastRing::destroy() {
+    return region.destroy();
+}
+
+ipclib::Result ipclib::BroadcastRing::publishBytes(const void* theData, const size_t theSize) {
+    if( !header ) return Result(EBADF);
+    if( theSize > header->max_msg_size ) return Result(EMSGSIZE);
+
+    uint64_t position = header->head.load(std::memory_order_relaxed);
+    Slot* slot = getSlot(position);
+
+    slot->sequence.store(position * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->size = theSize;
+    memcpy((char*)(slot) + sizeof(Slot), theData, theSize);
+
+    slot->sequence.store(position * 2 + 2, std::memory_order_release);
+    header->head.store(position + 1, std::memory_order_release);
+    header->published.store(position + 1, std::memory_order_release);
+
+    //one shared word for every subscriber keeps the cost of a publish independent of how many are listening
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( header->waiters.load(std::memory_order_relaxed) ) futexWake(&header->published);
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BroadcastRing::publish(const std::string& theMsg) {
+    return publishBytes(theMsg.c_str(), theMsg.size()+1);
+}
+
+//the slot at head - capacity is the one the writer overwrites next, so it is never handed out as the oldest
+uint64_t ipclib::BroadcastRing::getOldestPosition() const {
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    return head >= header->capacity ? head - header->capacity + 1 : 0;
+}
+
+ipclib::BroadcastRing::Subscriber ipclib::BroadcastRing::subscribe(const bool fromOldest) {
+    if( !header ) return Subscriber();
+    if( fromOldest ) return Subscriber(this, getOldestPosition());
+    else return Subscriber(this, header->head.load(std::memory_order_acquire));
+}
+
+ipclib::Result ipclib::BroadcastRing::waitFor(const uint64_t theCursor, const timespec* theDeadline) {
+    if( non_blocking ) return Result(EAGAIN);
+
+    for( unsigned int i = 0; i < SPIN_COUNT; i++ ) {
+        if( header->head.load(std::memory_order_acquire) > theCursor ) return Result(Result::SUCCESS);
+        cpuRelax();
+    }
+
+    //registering as a waiter before reading the word pairs with the fence in publishBytes(), so a wakeup can not be lost
+    header->waiters.fetch_add(1, std::memory_order_seq_cst);
+
+    Result res(Result::SUCCESS);
+    while( true ) {
+        uint32_t published = header->published.load(std::memory_order_acquire);
+        if( header->head.load(std::memory_order_acquire) > theCursor ) break;
+
+        int err = futexWait(&header->published, published, theDeadline);
+        if( err == ETIMEDOUT ) {
+            res = Result(ETIMEDOUT);
+            break;
+        }
+
+        if( err != 0 && err != EAGAIN && err != EINTR ) {
+            res = Result(err);
+            break;
+        }
+    }
+
+    header->waiters.fetch_sub(1, std::memory_order_relaxed);
+    return res;
+}
+
+ipclib::Result ipclib::BroadcastRing::readData(uint64_t& theCursor, uint64_t& theLost, void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const timespec* theDeadline) {
+    theReceivedSize = 0;
+    if( !header ) return Result(EBADF);
+
+    unsigned int spins = 0;
+    while( true ) {
+        Slot* slot = getSlot(theCursor);
+        uint64_t expected = theCursor * 2 + 2;
+        uint64_t before = slot->sequence.load(std::memory_order_acquire);
+
+        if( before == expected ) {
+            uint32_t size = slot->size;
+            if( size <= header->max_msg_size && size <= theBufferSize ) memcpy(theBuffer, (const char*)(slot) + sizeof(Slot), size);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if( slot->sequence.load(std::memory_order_relaxed) == before ) {
+                //like mq_receive, a message which does not fit is left for the next call with a bigger buffer
+                if( size > theBufferSize ) return Result(EMSGSIZE);
+
+                theCursor++;
+                theReceivedSize = size;
+                return Result(Result::SUCCESS);
+            }
+        }
+
+        //the publisher is in the middle of this very slot, a short spin usually sees it through
+        //past that it is waited for like an unpublished message, so a publisher which died halfway
+        //costs a subscriber its deadline or an EAGAIN, never a hang
+        else if( before == expected - 1 && spins < SPIN_COUNT ) {
+            spins++;
+            cpuRelax();
+            continue;
+        }
+
+        else if( before < expected ) {
+            spins = 0;
+            Result res = waitFor(theCursor, theDeadline);
+            if( !res ) return res;
+            continue;
+        }
+
+        //the writer lapped this cursor, either before the copy or during it
+        uint64_t oldest = getOldestPosition();
+        if( oldest > theCursor ) {
+            theLost = theLost + (oldest - theCursor);
+            theCursor = oldest;
+        }
+
+        return Result(EOVERFLOW, "Subscriber was overrun by the publisher");
+    }
+}
+
+long ipclib::BroadcastRing::Subscriber::getPendingNumber() const {
+    if( !ring || !ring->header ) return -1;
+    return ring->header->head.load(std::memory_order_acquire) - cursor;
+}
+
+ipclib::Result ipclib::BroadcastRing::Subscriber::receive(std::string& theBuffer) {
+    if( !ring || !ring->header ) return Result(EBADF);
+    theBuffer.resize(ring->getMaxMsgSize());
+
+    size_t received;
+    Result res = ring->readData(cursor, lost, &theBuffer[0], theBuffer.size(), received, nullptr);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::BroadcastRing::Subscriber::receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds) {
+    if( !ring || !ring->header ) return Result(EBADF);
+
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+
+    theBuffer.resize(ring->getMaxMsgSize());
+
+    size_t received;
+    Result res = ring->readData(cursor, lost, &theBuffer[0], theBuffer.size(), received, &tm);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::BroadcastRing::Subscriber::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize) {
+    if( !ring ) return Result(EBADF);
+    return ring->readData(cursor, lost, theBuffer, theBufferSize, theReceivedSize, nullptr);
+}
+
+ipclib::Result ipclib::BroadcastRing::Subscriber::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds) {
+    if( !ring ) return Result(EBADF);
+
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return ring->readData(cursor, lost, theBuffer, theBufferSize, theReceivedSize, &tm);
+}
@@ -0,0 +1,231 @@
+#include "buffer_pool.h"
+
+#include <unistd.h>
+#include <errno.h>
+
+#include "trace.h"
+
+ipclib::BufferPool::BufferPool(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theSlotNumber, const long theSlotSize, const MappingOptions& theOptions) : PosixObject() {
+    header = nullptr;
+    states = nullptr;
+    slots = nullptr;
+    create(theName, toCreate, toCreateExclusively, isNonBlocking, theSlotNumber, theSlotSize, theOptions);
+}
+
+size_t ipclib::BufferPool::getStatesSize(const uint32_t theSlotNumber) {
+    return ((theSlotNumber * sizeof(SlotState) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+}
+
+ipclib::Result ipclib::BufferPool::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theSlotNumber, const long theSlotSize, const MappingOptions& theOptions) {
+    if( already_initialized ) deallocateResources();
+
+    PosixObject::create(theName);
+
+    non_blocking = isNonBlocking;
+
+    if( theSlotNumber <= 0 || theSlotNumber > (1L << 20) || theSlotSize <= 0 || theSlotSize > (1L << 32) ) {
+        Result res(EINVAL);
+        IPCLIB_TRACE_EVENT(TRACE_BUFFER_POOL_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    uint32_t slot_number = theSlotNumber;
+    uint64_t slot_size = ((theSlotSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+
+    //only the process which actually creates the segment lays out the header, everyone else waits for the magic number
+    Result res = region.create(theName, sizeof(Header) + getStatesSize(slot_number) + slot_number * slot_size, toCreate, toCreateExclusively, SharedRegion::READ_AND_WRITE, theOptions);
+    if( !res ) {
+        IPCLIB_TRACE_EVENT(TRACE_BUFFER_POOL_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    bool owner = region.isOwner();
+    header = (Header*)(region.getAddress());
+    states = (SlotState*)(region.getData() + sizeof(Header));
+
+    if( owner ) {
+        header->slot_number = slot_number;
+        header->slot_size = slot_size;
+        for( uint32_t i = 0; i < slot_number; i++ ) {
+            states[i].generation.store(0, std::memory_order_relaxed);
+            states[i].next.store(i + 1 < slot_number ? i + 1 : NO_SLOT, std::memory_order_relaxed);
+        }
+        header->free_head.store(0, std::memory_order_relaxed);
+        header->free_number.store(slot_number, std::memory_order_relaxed);
+        header->releases.store(0, std::memory_order_relaxed);
+        header->waiters.store(0, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    else {
+        int attempts = 0;
+        while( region.getSize() >= sizeof(Header) && header->magic.load(std::memory_order_acquire) != MAGIC && attempts++ < 1000 ) usleep(100);
+
+        if( region.getSize() < sizeof(Header) || header->magic.load(std::memory_order_acquire) != MAGIC || sizeof(Header) + getStatesSize(header->slot_number) + header->slot_number * header->slot_size > region.getSize() ) {
+            res = Result(EAGAIN, "Pool is still being initialized");
+            IPCLIB_TRACE_EVENT(TRACE_BUFFER_POOL_CREATE, name, res.getError(), 0);
+            deallocateResources();
+            initialization_result = res;
+            return initialization_result;
+        }
+    }
+
+    slots = region.getData() + sizeof(Header) + getStatesSize(header->slot_number);
+
+    IPCLIB_TRACE_EVENT(TRACE_BUFFER_POOL_CREATE, name, 0, header->slot_number * header->slot_size);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::BufferPool::deallocateResources() {
+    header = nullptr;
+    states = nullptr;
+    slots = nullptr;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BufferPool::destroy() {
+    return region.destroy();
+}
+
+bool ipclib::BufferPool::pop(uint32_t& theSlot) {
+    uint64_t head = header->free_head.load(std::memory_order_acquire);
+
+    while( true ) {
+        uint32_t slot = head & 0xFFFFFFFF;
+        if( slot == NO_SLOT ) return false;
+
+        //next may already be stale when another process won the race, the tag makes the exchange fail in that case
+        uint64_t next = states[slot].next.load(std::memory_order_relaxed);
+        uint64_t tag = (head >> 32) + 1;
+        if( header->free_head.compare_exchange_weak(head, (tag << 32) | next, std::memory_order_acq_rel, std::memory_order_acquire) ) {
+            header->free_number.fetch_sub(1, std::memory_order_relaxed);
+            theSlot = slot;
+            return true;
+        }
+    }
+}
+
+void ipclib::BufferPool::push(const uint32_t theSlot) {
+    uint64_t head = header->free_head.load(std::memory_order_relaxed);
+
+    while( true ) {
+        states[theSlot].next.store(head & 0xFFFFFFFF, std::memory_order_relaxed);
+        uint64_t tag = (head >> 32) + 1;
+        if( header->free_head.compare_exchange_weak(head, (tag << 32) | theSlot, std::memory_order_release, std::memory_order_relaxed) ) break;
+    }
+
+    header->free_number.fetch_add(1, std::memory_order_relaxed);
+
+    header->releases.fetch_add(1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( header->waiters.load(std::memory_order_relaxed) ) futexWake(&header->releases, 1);
+}
+
+ipclib::Result ipclib::BufferPool::acquireBuffer(Buffer& theBuffer, const timespec* theDeadline) {
+    if( !header ) return Result(EBADF);
+
+    uint32_t slot;
+    bool found = pop(slot);
+
+    for( unsigned int i = 0; !found && !non_blocking && i < SPIN_COUNT; i++ ) {
+        cpuRelax();
+        found = pop(slot);
+    }
+
+    if( !found && non_blocking ) return Result(EAGAIN);
+
+    if( !found ) {
+        //registering as a waiter before reading the counter pairs with the fence in push(), so a wakeup can not be lost
+        header->waiters.fetch_add(1, std::memory_order_seq_cst);
+
+        Result res(Result::SUCCESS);
+        while( true ) {
+            uint32_t releases = header->releases.load(std::memory_order_acquire);
+            if( pop(slot) ) break;
+
+            int err = futexWait(&header->releases, releases, theDeadline);
+            if( err == ETIMEDOUT ) {
+                res = Result(ETIMEDOUT);
+                break;
+            }
+
+            if( err != 0 && err != EAGAIN && err != EINTR ) {
+                res = Result(err);
+                break;
+            }
+        }
+
+        header->waiters.fetch_sub(1, std::memory_order_relaxed);
+        if( !res ) return res;
+    }
+
+    theBuffer.data = slots + slot * header->slot_size;
+    theBuffer.capacity = header->slot_size;
+    theBuffer.slot = slot;
+    theBuffer.generation = states[slot].generation.load(std::memory_order_acquire);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BufferPool::acquire(Buffer& theBuffer) {
+    return acquireBuffer(theBuffer, nullptr);
+}
+
+ipclib::Result ipclib::BufferPool::acquire(Buffer& theBuffer, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return acquireBuffer(theBuffer, &tm);
+}
+
+ipclib::Result ipclib::BufferPool::acquire(Buffer& theBuffer, const Deadline& theDeadline) {
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::MONOTONIC, tm);
+    if( !res ) return res;
+
+    return acquireBuffer(theBuffer, &tm);
+}
+
+ipclib::Result ipclib::BufferPool::getDescriptor(const Buffer& theBuffer, const size_t theLength, const size_t theOffset, Descriptor& theDescriptor) const {
+    if( !header ) return Result(EBADF);
+    if( theBuffer.slot >= header->slot_number || theOffset > header->slot_size || theLength > header->slot_size - theOffset ) return Result(EINVAL);
+
+    theDescriptor.slot = theBuffer.slot;
+    theDescriptor.generation = theBuffer.generation;
+    theDescriptor.offset = theOffset;
+    theDescriptor.length = theLength;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BufferPool::getData(const Descriptor& theDescriptor, const char*& theData) const {
+    theData = nullptr;
+    if( !header ) return Result(EBADF);
+
+    //descriptors come from another process, nothing in them is trusted before it is checked against the pool
+    if( theDescriptor.slot >= header->slot_number || theDescriptor.offset > header->slot_size || theDescriptor.length > header->slot_size - theDescriptor.offset ) return Result(EINVAL, "Descriptor does not fit in the pool");
+    if( states[theDescriptor.slot].generation.load(std::memory_order_acquire) != theDescriptor.generation ) return Result(ESTALE, "Descriptor refers to a released buffer");
+
+    theData = slots + theDescriptor.slot * header->slot_size + theDescriptor.offset;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BufferPool::release(const uint32_t theSlot, const uint32_t theGeneration) {
+    if( !header ) return Result(EBADF);
+    if( theSlot >= header->slot_number ) return Result(EINVAL);
+
+    //only the holder of the current generation can move it on, so a double release is refused instead of corrupting the free list
+    uint32_t generation = theGeneration;
+    if( !states[theSlot].generation.compare_exchange_strong(generation, theGeneration + 1, std::memory_order_acq_rel) ) return Result(ESTALE, "Buffer was already released");
+
+    push(theSlot);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::BufferPool::release(const Buffer& theBuffer) {
+    return release(theBuffer.slot, theBuffer.generation);
+}
+
+ipclib::Result ipclib::BufferPool::release(const Descriptor& theDescriptor) {
+    return release(theDescriptor.slot, theDescriptor.generation);
+}
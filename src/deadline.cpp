@@ -0,0 +1,68 @@
+#include "deadline.h"
+
+#include <errno.h>
+
+void ipclib::Deadline::normalize(timespec& theTime) {
+    theTime.tv_sec = theTime.tv_sec + theTime.tv_nsec / 1000000000L;
+    theTime.tv_nsec = theTime.tv_nsec % 1000000000L;
+
+    if( theTime.tv_nsec < 0 ) {
+        theTime.tv_sec--;
+        theTime.tv_nsec = theTime.tv_nsec + 1000000000L;
+    }
+}
+
+//a default constructed deadline is already expired, timed operations given one do not block
+ipclib::Deadline::Deadline() {
+    clock = MONOTONIC;
+    time.tv_sec = 0;
+    time.tv_nsec = 0;
+    is_converted = false;
+}
+
+ipclib::Deadline::Deadline(const long theSeconds, const long theNanoSeconds, const Clock& theClock) {
+    clock = theClock;
+    is_converted = false;
+
+    clock_gettime(clock, &time);
+    time.tv_sec = time.tv_sec + theSeconds;
+    time.tv_nsec = time.tv_nsec + theNanoSeconds;
+    normalize(time);
+}
+
+ipclib::Deadline ipclib::Deadline::at(const timespec& theTime, const Clock& theClock) {
+    Deadline deadline;
+    deadline.clock = theClock;
+    deadline.time = theTime;
+    normalize(deadline.time);
+    return deadline;
+}
+
+ipclib::Result ipclib::Deadline::getTime(const Clock& theClock, timespec& theTime) const {
+    if( theClock == clock ) {
+        theTime = time;
+        return Result(Result::SUCCESS);
+    }
+
+    if( !is_converted ) {
+        timespec now;
+        timespec other_now;
+        if( clock_gettime(clock, &now) == -1 || clock_gettime(theClock, &other_now) == -1 ) return Result(errno);
+
+        converted.tv_sec = other_now.tv_sec + (time.tv_sec - now.tv_sec);
+        converted.tv_nsec = other_now.tv_nsec + (time.tv_nsec - now.tv_nsec);
+        normalize(converted);
+        is_converted = true;
+    }
+
+    theTime = converted;
+    return Result(Result::SUCCESS);
+}
+
+long long ipclib::Deadline::getRemaining() const {
+    timespec now;
+    if( clock_gettime(clock, &now) == -1 ) return 0;
+
+    long long remaining = (long long)(time.tv_sec - now.tv_sec) * 1000000000LL + (time.tv_nsec - now.tv_nsec);
+    return remaining > 0 ? remaining : 0;
+}
@@ -0,0 +1,58 @@
+#include "event.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::Event::Event(const unsigned int theValue, const bool isNonBlocking, const bool isSemaphore) {
+    event_fd = -1;
+    create(theValue, isNonBlocking, isSemaphore);
+}
+
+ipclib::Result ipclib::Event::create(const unsigned int theValue, const bool isNonBlocking, const bool isSemaphore) {
+    if( event_fd != -1 ) deallocateResources();
+
+    int flags = EFD_CLOEXEC;
+    if( isNonBlocking ) flags = flags | EFD_NONBLOCK;
+    if( isSemaphore ) flags = flags | EFD_SEMAPHORE;
+
+    if( (event_fd = eventfd(theValue, flags)) == -1 ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_EVENT_CREATE, "", res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_EVENT_CREATE, "", 0, 0);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::Event::deallocateResources() {
+    if( event_fd == -1 ) return Result(Result::SUCCESS);
+
+    int fd = event_fd;
+    event_fd = -1;
+
+    if( close(fd) == 0 ) return Result(Result::SUCCESS);
+    else return Result(errno);
+}
+
+ipclib::Result ipclib::Event::signal(const uint64_t theCount) {
+    if( write(event_fd, &theCount, sizeof(uint64_t)) == sizeof(uint64_t) ) return Result(Result::SUCCESS);
+    else return Result(errno);
+}
+
+ipclib::Result ipclib::Event::consume(uint64_t& theCount) {
+    theCount = 0;
+    if( read(event_fd, &theCount, sizeof(uint64_t)) == sizeof(uint64_t) ) return Result(Result::SUCCESS);
+    else return Result(errno);
+}
+
+ipclib::Result ipclib::Event::consume() {
+    uint64_t count;
+    return consume(count);
+}
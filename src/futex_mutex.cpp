@@ -0,0 +1,36 @@
+#include "futex_mutex.h"
+
+#include <errno.h>
+#include <string.h>
+
+ipclib::Result ipclib::FutexMutex::lockSlow(const timespec* theDeadline) {
+    for( unsigned int i = 0; i < SPIN_COUNT; i++ ) {
+        if( state.load(std::memory_order_relaxed) == UNLOCKED && tryLock() ) return Result(Result::SUCCESS);
+        cpuRelax();
+    }
+
+    //once anybody sleeps the state stays CONTENDED, so the owner knows it has to wake someone on unlock
+    uint32_t current = state.exchange(CONTENDED, std::memory_order_acquire);
+    while( current != UNLOCKED ) {
+        int err = futexWait(&state, CONTENDED, theDeadline);
+        if( err == ETIMEDOUT ) return Result(ETIMEDOUT);
+        if( err != 0 && err != EAGAIN && err != EINTR ) return Result(err);
+
+        current = state.exchange(CONTENDED, std::memory_order_acquire);
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+void ipclib::FutexMutex::unlockSlow() {
+    state.store(UNLOCKED, std::memory_order_release);
+    futexWake(&state, 1);
+}
+
+ipclib::Result ipclib::FutexMutex::lock(const long theSeconds, const long theNanoSeconds) {
+    if( tryLock() ) return Result(Result::SUCCESS);
+
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return lockSlow(&tm);
+}
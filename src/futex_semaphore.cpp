@@ -0,0 +1,45 @@
+#include "futex_semaphore.h"
+
+#include <errno.h>
+#include <string.h>
+
+ipclib::Result ipclib::FutexSemaphore::waitSlow(const timespec* theDeadline) {
+    //waiters is raised before value is reread, pairing with the increment-then-check order in signal()
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+
+    Result res(Result::SUCCESS);
+    while( !tryWait() ) {
+        int err = futexWait(&value, 0, theDeadline);
+        if( err == ETIMEDOUT ) {
+            res = Result(ETIMEDOUT);
+            break;
+        }
+
+        if( err != 0 && err != EAGAIN && err != EINTR ) {
+            res = Result(err);
+            break;
+        }
+    }
+
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+    return res;
+}
+
+ipclib::Result ipclib::FutexSemaphore::wait(const long theSeconds, const long theNanoSeconds) {
+    if( tryWait() ) return Result(Result::SUCCESS);
+
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return waitSlow(&tm);
+}
+
+ipclib::Result ipclib::FutexSemaphore::signal() {
+    value.fetch_add(1, std::memory_order_seq_cst);
+
+    if( waiters.load(std::memory_order_seq_cst) ) {
+        int err = futexWake(&value, 1);
+        if( err != 0 ) return Result(err);
+    }
+
+    return Result(Result::SUCCESS);
+}
@@ -0,0 +1,124 @@
+#include "mapping_options.h"
+
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <sys/syscall.h>
+#include <linux/magic.h>
+#include <linux/mempolicy.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <vector>
+
+#include "thread.h"
+
+ipclib::MappingOptions::MappingOptions() {
+    populate = false;
+    lock = false;
+    huge_pages = HUGE_PAGES_NONE;
+    huge_pages_required = false;
+    advice = NO_ADVICE;
+    hugetlbfs_path = "/dev/hugepages";
+    numa_node = NO_NUMA_NODE;
+    numa_node_required = false;
+}
+
+bool ipclib::MappingOptions::isHugetlbfsMounted() const {
+    struct statfs st;
+    return statfs(hugetlbfs_path.c_str(), &st) == 0 && (unsigned long)(st.f_type) == HUGETLBFS_MAGIC;
+}
+
+//with HUGE_PAGES_HUGETLBFS the segment is a file in the hugetlbfs mount, and theFilePath is set to it
+//only a missing mount falls back to /dev/shm, when huge pages are not required: that is where every process
+//without the mount creates and looks for the segment, while a file missing from a mount that exists is just ENOENT
+int ipclib::MappingOptions::openSegment(const std::string& thePosixName, const int theFlags, const mode_t thePermission, std::string& theFilePath) const {
+    theFilePath.clear();
+
+    if( huge_pages == HUGE_PAGES_HUGETLBFS ) {
+        if( isHugetlbfsMounted() ) {
+            std::string path = hugetlbfs_path + thePosixName;
+            int fd = open(path.c_str(), theFlags, thePermission);
+            if( fd >= 0 ) theFilePath = path;
+            return fd;
+        }
+
+        if( huge_pages_required ) {
+            errno = ENOENT;
+            return -1;
+        }
+    }
+
+    return shm_open(thePosixName.c_str(), theFlags, thePermission);
+}
+
+int ipclib::MappingOptions::unlinkSegment(const std::string& thePosixName, const std::string& theFilePath) {
+    if( !theFilePath.empty() ) return unlink(theFilePath.c_str());
+    else return shm_unlink(thePosixName.c_str());
+}
+
+size_t ipclib::MappingOptions::getSegmentSize(const int theDescriptor, const size_t theSize, const std::string& theFilePath) {
+    if( theFilePath.empty() ) return theSize;
+
+    //hugetlbfs only accepts sizes which are a multiple of its page size
+    struct statfs st;
+    if( fstatfs(theDescriptor, &st) == -1 || st.f_bsize <= 0 ) return theSize;
+
+    size_t page_size = st.f_bsize;
+    return ((theSize + page_size - 1) / page_size) * page_size;
+}
+
+int ipclib::MappingOptions::getMmapFlags() const {
+    int flags = MAP_SHARED;
+    //with a NUMA node the pages are faulted in by apply(), once the memory policy is in place
+    if( populate && numa_node == NO_NUMA_NODE ) flags = flags | MAP_POPULATE;
+    return flags;
+}
+
+ipclib::Result ipclib::MappingOptions::bindNumaNode(void* theAddress, const size_t theSize) const {
+    int node = numa_node;
+    if( node == CURRENT_NUMA_NODE ) node = Thread::getCurrentNumaNode();
+    if( node < 0 ) return Result(EINVAL);
+
+    const size_t bits = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] = 1UL << (node % bits);
+
+    //the policy of a shared segment belongs to the segment, but only MPOL_MF_MOVE_ALL migrates the pages
+    //other processes already faulted in, and that takes CAP_SYS_NICE: without it MPOL_MF_MOVE only moves
+    //the pages nobody else maps, the rest stay where they are and just the pages faulted in from now on follow the policy
+    int mode = numa_node_required ? MPOL_BIND : MPOL_PREFERRED;
+    long res = syscall(SYS_mbind, theAddress, theSize, mode, &mask[0], mask.size() * bits + 1, MPOL_MF_MOVE_ALL);
+    if( res == -1 && errno == EPERM ) res = syscall(SYS_mbind, theAddress, theSize, mode, &mask[0], mask.size() * bits + 1, MPOL_MF_MOVE);
+    //a kernel built without NUMA has nothing to prefer, any other refusal is reported even for a mere preference
+    if( res == -1 && (numa_node_required || errno != ENOSYS) ) return Result(errno);
+
+    if( populate ) {
+        long page_size = sysconf(_SC_PAGESIZE);
+        for( size_t offset = 0; offset < theSize; offset = offset + page_size ) (void)(*((volatile char*)(theAddress) + offset));
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::MappingOptions::apply(void* theAddress, const size_t theSize, const std::string& theFilePath) const {
+    if( numa_node != NO_NUMA_NODE ) {
+        Result res = bindNumaNode(theAddress, theSize);
+        if( !res ) return res;
+    }
+
+    if( huge_pages == HUGE_PAGES_TRANSPARENT || (huge_pages == HUGE_PAGES_HUGETLBFS && theFilePath.empty()) ) {
+        if( madvise(theAddress, theSize, MADV_HUGEPAGE) == -1 && huge_pages_required ) return Result(errno);
+    }
+
+    if( advice != NO_ADVICE ) {
+        if( madvise(theAddress, theSize, advice) == -1 ) return Result(errno);
+    }
+
+    if( lock ) {
+        if( mlock(theAddress, theSize) == -1 ) return Result(errno);
+    }
+
+    return Result(Result::SUCCESS);
+}
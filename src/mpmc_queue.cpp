@@ -0,0 +1,261 @@
+#include "mpmc_queue.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::MpmcQueue::MpmcQueue(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theMaxMsgSize) : PosixObject() {
+    header = nullptr;
+    slots = nullptr;
+    create(theName, toCreate, toCreateExclusively, isNonBlocking, theMaxMsg, theMaxMsgSize);
+}
+
+long ipclib::MpmcQueue::getMsgNumber() const {
+    if( !header ) return -1;
+
+    uint64_t dequeue = header->dequeue_position.load(std::memory_order_acquire);
+    uint64_t enqueue = header->enqueue_position.load(std::memory_order_acquire);
+    if( enqueue < dequeue ) return 0;
+    if( enqueue - dequeue > header->capacity ) return header->capacity;
+    return enqueue - dequeue;
+}
+
+bool ipclib::MpmcQueue::isFull() const {
+    uint64_t position = header->enqueue_position.load(std::memory_order_acquire);
+    return (int64_t)(getSlot(position)->sequence.load(std::memory_order_acquire) - position) < 0;
+}
+
+bool ipclib::MpmcQueue::isDrained() const {
+    uint64_t position = header->dequeue_position.load(std::memory_order_acquire);
+    return (int64_t)(getSlot(position)->sequence.load(std::memory_order_acquire) - (position + 1)) < 0;
+}
+
+ipclib::Result ipclib::MpmcQueue::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theMaxMsgSize) {
+    if( already_initialized ) deallocateResources();
+
+    PosixObject::create(theName);
+
+    non_blocking = isNonBlocking;
+
+    if( theMaxMsg <= 0 || theMaxMsg > (1L << 30) || theMaxMsgSize <= 0 || theMaxMsgSize > (1L << 30) ) {
+        Result res(EINVAL);
+        IPCLIB_TRACE_EVENT(TRACE_MPMC_QUEUE_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    uint32_t capacity = 1;
+    while( capacity < (uint32_t)(theMaxMsg) ) capacity = capacity << 1;
+    uint32_t slot_size = ((sizeof(Slot) + theMaxMsgSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+
+    //only the process which actually creates the segment lays out the header, everyone else waits for the magic number
+    Result res = region.create(theName, sizeof(Header) + (size_t)(capacity) * slot_size, toCreate, toCreateExclusively);
+    if( !res ) {
+        IPCLIB_TRACE_EVENT(TRACE_MPMC_QUEUE_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    bool owner = region.isOwner();
+    header = (Header*)(region.getAddress());
+    slots = region.getData() + sizeof(Header);
+
+    if( owner ) {
+        header->capacity = capacity;
+        header->max_msg_size = theMaxMsgSize;
+        header->slot_size = slot_size;
+        header->enqueue_position.store(0, std::memory_order_relaxed);
+        header->dequeue_position.store(0, std::memory_order_relaxed);
+        header->not_empty.store(0, std::memory_order_relaxed);
+        header->consumers_waiting.store(0, std::memory_order_relaxed);
+        header->not_full.store(0, std::memory_order_relaxed);
+        header->producers_waiting.store(0, std::memory_order_relaxed);
+        for( uint64_t i = 0; i < capacity; i++ ) getSlot(i)->sequence.store(i, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    else {
+        int attempts = 0;
+        while( region.getSize() >= sizeof(Header) && header->magic.load(std::memory_order_acquire) != MAGIC && attempts++ < 1000 ) usleep(100);
+
+        if( region.getSize() < sizeof(Header) || header->magic.load(std::memory_order_acquire) != MAGIC || sizeof(Header) + (size_t)(header->capacity) * header->slot_size > region.getSize() ) {
+            res = Result(EAGAIN, "Queue is still being initialized");
+            IPCLIB_TRACE_EVENT(TRACE_MPMC_QUEUE_CREATE, name, res.getError(), 0);
+            deallocateResources();
+            initialization_result = res;
+            return initialization_result;
+        }
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_MPMC_QUEUE_CREATE, name, 0, 0);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::MpmcQueue::deallocateResources() {
+    header = nullptr;
+    slots = nullptr;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::MpmcQueue::destroy() {
+    return region.destroy();
+}
+
+ipclib::Result ipclib::MpmcQueue::waitFor(bool (MpmcQueue::*theCondition)() const, std::atomic<uint32_t>& theEvent, std::atomic<uint32_t>& theWaiters, const timespec* theDeadline) {
+    if( non_blocking ) return Result(EAGAIN);
+
+    for( unsigned int i = 0; i < SPIN_COUNT; i++ ) {
+        if( !(this->*theCondition)() ) return Result(Result::SUCCESS);
+        cpuRelax();
+    }
+
+    //registering as a waiter before reading the event pairs with the fence in notify(), so a wakeup can not be lost
+    theWaiters.fetch_add(1, std::memory_order_seq_cst);
+
+    Result res(Result::SUCCESS);
+    while( true ) {
+        uint32_t event = theEvent.load(std::memory_order_acquire);
+        if( !(this->*theCondition)() ) break;
+
+        int err = futexWait(&theEvent, event, theDeadline);
+        if( err == ETIMEDOUT ) {
+            res = Result(ETIMEDOUT);
+            break;
+        }
+
+        if( err != 0 && err != EAGAIN && err != EINTR ) {
+            res = Result(err);
+            break;
+        }
+    }
+
+    theWaiters.fetch_sub(1, std::memory_order_relaxed);
+    return res;
+}
+
+void ipclib::MpmcQueue::notify(std::atomic<uint32_t>& theEvent, std::atomic<uint32_t>& theWaiters) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( theWaiters.load(std::memory_order_relaxed) ) {
+        theEvent.fetch_add(1, std::memory_order_release);
+        futexWake(&theEvent);
+    }
+}
+
+ipclib::Result ipclib::MpmcQueue::sendData(const void* theData, const size_t theSize, const timespec* theDeadline) {
+    if( !header ) return Result(EBADF);
+    if( theSize > header->max_msg_size ) return Result(EMSGSIZE);
+
+    //a slot is free for position p when its sequence equals p, and it is claimed by advancing enqueue_position
+    Slot* slot;
+    uint64_t position = header->enqueue_position.load(std::memory_order_relaxed);
+    while( true ) {
+        slot = getSlot(position);
+        int64_t difference = (int64_t)(slot->sequence.load(std::memory_order_acquire) - position);
+
+        if( difference == 0 ) {
+            if( header->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) ) break;
+        }
+
+        else if( difference < 0 ) {
+            Result res = waitFor(&MpmcQueue::isFull, header->not_full, header->producers_waiting, theDeadline);
+            if( !res ) return res;
+            position = header->enqueue_position.load(std::memory_order_relaxed);
+        }
+
+        else position = header->enqueue_position.load(std::memory_order_relaxed);
+    }
+
+    slot->size = theSize;
+    memcpy((char*)(slot) + sizeof(Slot), theData, theSize);
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    notify(header->not_empty, header->consumers_waiting);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::MpmcQueue::receiveData(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const timespec* theDeadline) {
+    theReceivedSize = 0;
+    if( !header ) return Result(EBADF);
+
+    Slot* slot;
+    uint64_t position = header->dequeue_position.load(std::memory_order_relaxed);
+    while( true ) {
+        slot = getSlot(position);
+        int64_t difference = (int64_t)(slot->sequence.load(std::memory_order_acquire) - (position + 1));
+
+        if( difference == 0 ) {
+            //like mq_receive, a message which does not fit is left in the queue
+            if( slot->size > theBufferSize ) return Result(EMSGSIZE);
+            if( header->dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) ) break;
+        }
+
+        else if( difference < 0 ) {
+            Result res = waitFor(&MpmcQueue::isDrained, header->not_empty, header->consumers_waiting, theDeadline);
+            if( !res ) return res;
+            position = header->dequeue_position.load(std::memory_order_relaxed);
+        }
+
+        else position = header->dequeue_position.load(std::memory_order_relaxed);
+    }
+
+    theReceivedSize = slot->size;
+    memcpy(theBuffer, (char*)(slot) + sizeof(Slot), theReceivedSize);
+    slot->sequence.store(position + header->capacity, std::memory_order_release);
+
+    notify(header->not_full, header->producers_waiting);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::MpmcQueue::send(const std::string& theMsg) {
+    return sendData(theMsg.c_str(), theMsg.size()+1, nullptr);
+}
+
+ipclib::Result ipclib::MpmcQueue::send(const std::string& theMsg, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return sendData(theMsg.c_str(), theMsg.size()+1, &tm);
+}
+
+ipclib::Result ipclib::MpmcQueue::receive(std::string& theBuffer) {
+    if( header ) theBuffer.resize(header->max_msg_size);
+
+    size_t received;
+    Result res = receiveData(&theBuffer[0], theBuffer.size(), received, nullptr);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::MpmcQueue::receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+
+    if( header ) theBuffer.resize(header->max_msg_size);
+
+    size_t received;
+    Result res = receiveData(&theBuffer[0], theBuffer.size(), received, &tm);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::MpmcQueue::sendBytes(const void* theData, const size_t theSize) {
+    return sendData(theData, theSize, nullptr);
+}
+
+ipclib::Result ipclib::MpmcQueue::sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return sendData(theData, theSize, &tm);
+}
+
+ipclib::Result ipclib::MpmcQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize) {
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, nullptr);
+}
+
+ipclib::Result ipclib::MpmcQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, &tm);
+}
@@ -4,25 +4,28 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
+#include <stdio.h>
+#include <time.h>
 
-#ifdef NDEBUG
-#include <iostream>
-#endif
+#include "trace.h"
 
-ipclib::MsgQueue::MsgQueue(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const Protection& theProtection) : PosixObject() {
-    create(theName, toCreate, toCreateExclusively, isNonBlocking, theProtection);
-}
+namespace {
+    const size_t STACK_BUFFER_SIZE = 4096;
 
-long ipclib::MsgQueue::getMaxMsgSize() {
-    mq_attr attribute;
-    if( getPosixAttribute(&attribute) ) return attribute.mq_msgsize;
-    else return ATTRIBUTE_ERROR;
+    long getSystemLimit(const char* thePath, const long theFallback) {
+        long value = theFallback;
+        FILE* file = fopen(thePath, "r");
+        if( !file ) return theFallback;
+
+        if( fscanf(file, "%ld", &value) != 1 || value <= 0 ) value = theFallback;
+        fclose(file);
+        return value;
+    }
 }
 
-long ipclib::MsgQueue::getMaxMsg() {
-    mq_attr attribute;
-    if( getPosixAttribute(&attribute) ) return attribute.mq_maxmsg;
-    else return ATTRIBUTE_ERROR;
+ipclib::MsgQueue::MsgQueue(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const Protection& theProtection, const long theMaxMsg, const long theMaxMsgSize) : PosixObject() {
+    cached_attribute.mq_msgsize = cached_attribute.mq_maxmsg = ATTRIBUTE_ERROR;
+    create(theName, toCreate, toCreateExclusively, isNonBlocking, theProtection, theMaxMsg, theMaxMsgSize);
 }
 
 long ipclib::MsgQueue::getMsgNumber() {
@@ -41,15 +44,17 @@ bool ipclib::MsgQueue::isNonBlocking() {
     else return ATTRIBUTE_ERROR;
 }
 
-ipclib::Result ipclib::MsgQueue::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const Protection& theProtection) {
+//the messages already waiting are the starting depth
+ipclib::Result ipclib::MsgQueue::enableMetrics() {
+    long depth = getMsgNumber();
+    return metrics.enable(STATS_MSG_QUEUE, name, depth > 0 ? depth : 0);
+}
+
+ipclib::Result ipclib::MsgQueue::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const Protection& theProtection, const long theMaxMsg, const long theMaxMsgSize) {
     if( already_initialized ) deallocateResources();
 
     PosixObject::create(theName);
 
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: starting initialization for " << name << "...";
-    #endif
-
     protection = theProtection;
     int oflag;
     if( theProtection == READ_ONLY ) oflag = O_RDONLY;
@@ -60,19 +65,36 @@ ipclib::Result ipclib::MsgQueue::create(const std::string& theName, const bool t
     if( toCreateExclusively ) oflag = oflag | O_EXCL;
     if( isNonBlocking ) oflag = oflag | O_NONBLOCK;
 
-    if( (msg_queue = mq_open(posix_name.c_str(), oflag, DEFAULT_PERMISSION, NULL)) == (mqd_t)(-1) ) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+    cached_attribute.mq_msgsize = cached_attribute.mq_maxmsg = ATTRIBUTE_ERROR;
+
+    //mq_open needs both limits at once, so a missing one is taken from the system defaults
+    //without any limit the kernel applies its defaults itself and /proc is not read at all
+    mq_attr requested_attribute;
+    memset(&requested_attribute, 0, sizeof(mq_attr));
+    bool has_attribute = theMaxMsg > 0 || theMaxMsgSize > 0;
+    if( has_attribute ) {
+        requested_attribute.mq_maxmsg = theMaxMsg > 0 ? theMaxMsg : getSystemLimit("/proc/sys/fs/mqueue/msg_default", 10);
+        requested_attribute.mq_msgsize = theMaxMsgSize > 0 ? theMaxMsgSize : getSystemLimit("/proc/sys/fs/mqueue/msgsize_default", 8192);
+    }
+
+    if( (msg_queue = mq_open(posix_name.c_str(), oflag, DEFAULT_PERMISSION, has_attribute ? &requested_attribute : NULL)) == (mqd_t)(-1) ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    //mq_msgsize and mq_maxmsg are fixed for the lifetime of the queue, so they are read only once here
+    else if( mq_getattr(msg_queue, &cached_attribute) == -1 ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_CREATE, name, res.getError(), 0);
+        cached_attribute.mq_msgsize = cached_attribute.mq_maxmsg = ATTRIBUTE_ERROR;
         initialization_result = res;
         return initialization_result;
     }
 
     else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_CREATE, name, 0, 0);
 
         initialization_result = Result(Result::SUCCESS);
         return initialization_result;
@@ -80,196 +102,479 @@ ipclib::Result ipclib::MsgQueue::create(const std::string& theName, const bool t
 }
 
 ipclib::Result ipclib::MsgQueue::deallocateResources() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: deallocating resources for " << name << "...";
-    #endif
-
     if( mq_close(msg_queue) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_CLOSE, name, 0, 0);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_CLOSE, name, res.getError(), 0);
         return res;
     }
 }
 
 ipclib::Result ipclib::MsgQueue::getPosixAttribute(mq_attr* theAttribute) {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: retrieving the POSIX attribute for message queue " << name << "...";
-    #endif
-
     if( mq_getattr(msg_queue, theAttribute) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_GET_ATTRIBUTE, name, 0, 0);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_GET_ATTRIBUTE, name, res.getError(), 0);
         return res;
     }
 }
 
 ipclib::Result ipclib::MsgQueue::destroy() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: destroying message queue " << name << "...";
-    #endif
-
     if( mq_unlink(posix_name.c_str()) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_DESTROY, name, 0, 0);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_DESTROY, name, res.getError(), 0);
         return res;
     }
 }
 
-ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg) {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: sending message " << theMsg << " on " << name << "...";
-    #endif
-
-    if( mq_send(msg_queue, theMsg.c_str(), theMsg.size()+1, 0) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+ipclib::Result ipclib::MsgQueue::getTimeout(const long theSeconds, const long theNanoSeconds, timespec& theTimeout) {
+    if( clock_gettime(CLOCK_REALTIME, &theTimeout) == -1 ) return Result(errno);
+
+    theTimeout.tv_sec = theTimeout.tv_sec + theSeconds;
+    theTimeout.tv_nsec = theTimeout.tv_nsec + theNanoSeconds;
+    Deadline::normalize(theTimeout);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::MsgQueue::sendData(const void* theData, const size_t theSize, const unsigned int thePriority, const timespec* theTimeout) {
+    //a non blocking queue never sleeps in the call, so none of its time counts as blocked
+    bool can_block = !(cached_attribute.mq_flags & O_NONBLOCK);
+    long blocking_start = can_block ? metrics.startBlocking() : 0;
+
+    int err;
+    if( theTimeout ) err = mq_timedsend(msg_queue, (const char*)(theData), theSize, thePriority, theTimeout);
+    else err = mq_send(msg_queue, (const char*)(theData), theSize, thePriority);
+
+    if( can_block ) metrics.stopBlocking(blocking_start);
+
+    if( err == 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_SEND, name, 0, theSize);
+        metrics.onOperation(theSize);
+        metrics.onDepthChange(1);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_SEND, name, res.getError(), theSize);
+        metrics.onError(res.getError());
         return res;
     }
 }
 
-ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer) {
-    theBuffer.clear();
+ipclib::Result ipclib::MsgQueue::receiveData(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, unsigned int* thePriority, const timespec* theTimeout) {
+    theReceivedSize = 0;
 
-    long buffersize;
-    if( (buffersize = getMaxMsgSize()) == ATTRIBUTE_ERROR ) return Result(-1, "Error in retrieving message buffer size");
-    else buffersize++;
+    if( cached_attribute.mq_msgsize == ATTRIBUTE_ERROR ) return Result(ATTRIBUTE_ERROR, "Error in retrieving message buffer size");
 
-    char* buffer = new char[buffersize];
+    //mq_receive refuses buffers smaller than mq_msgsize, so those go through a scratch buffer of the calling thread
+    //small queues use the stack, bigger ones a per thread buffer that only grows, both are safe for concurrent receivers
+    char stack_buffer[STACK_BUFFER_SIZE];
+    static thread_local std::vector<char> thread_buffer;
 
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: receiving message on "<< name << "...";
-    #endif
+    char* buffer = (char*)(theBuffer);
+    if( theBufferSize < (size_t)(cached_attribute.mq_msgsize) ) {
+        if( (size_t)(cached_attribute.mq_msgsize) <= STACK_BUFFER_SIZE ) buffer = stack_buffer;
+        else {
+            if( thread_buffer.size() < (size_t)(cached_attribute.mq_msgsize) ) thread_buffer.resize(cached_attribute.mq_msgsize);
+            buffer = thread_buffer.data();
+        }
+    }
 
-    if( mq_receive(msg_queue, buffer, buffersize, NULL) == -1 ) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
-        delete [] buffer;
+    bool can_block = !(cached_attribute.mq_flags & O_NONBLOCK);
+    long blocking_start = can_block ? metrics.startBlocking() : 0;
+
+    ssize_t received;
+    if( theTimeout ) received = mq_timedreceive(msg_queue, buffer, cached_attribute.mq_msgsize, thePriority, theTimeout);
+    else received = mq_receive(msg_queue, buffer, cached_attribute.mq_msgsize, thePriority);
+
+    if( can_block ) metrics.stopBlocking(blocking_start);
+
+    if( received == -1 ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_RECEIVE, name, res.getError(), 0);
+        metrics.onError(res.getError());
         return res;
     }
 
-    else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
-        theBuffer = buffer;
-        delete [] buffer;
-        return Result(Result::SUCCESS);
+    theReceivedSize = received;
+    metrics.onOperation(theReceivedSize);
+    metrics.onDepthChange(-1);
+
+    //the message is already off the queue, so whatever fits is still handed over together with its real size
+    if( buffer != theBuffer ) {
+        if( theReceivedSize > theBufferSize ) {
+            memcpy(theBuffer, buffer, theBufferSize);
+
+            Result res(EMSGSIZE, "Received message does not fit in the provided buffer");
+            IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_RECEIVE, name, res.getError(), theReceivedSize);
+            return res;
+        }
+
+        memcpy(theBuffer, buffer, theReceivedSize);
     }
+
+    IPCLIB_TRACE_EVENT(TRACE_MSG_QUEUE_RECEIVE, name, 0, theReceivedSize);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveValue(void* theValue, const size_t theSize, unsigned int* thePriority, const timespec* theTimeout) {
+    size_t received;
+    Result res = receiveData(theValue, theSize, received, thePriority, theTimeout);
+    if( res && received != theSize ) return Result(EMSGSIZE, "Received message size does not match the requested type");
+    return res;
+}
+
+ipclib::Result ipclib::MsgQueue::receiveString(std::string& theBuffer, unsigned int* thePriority, const timespec* theTimeout) {
+    //resizing within the existing capacity does not allocate, so a reused buffer costs nothing after the first call
+    if( cached_attribute.mq_msgsize != ATTRIBUTE_ERROR ) theBuffer.resize(cached_attribute.mq_msgsize);
+
+    size_t received;
+    Result res = receiveData(&theBuffer[0], theBuffer.size(), received, thePriority, theTimeout);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg) {
+    return sendData(theMsg.c_str(), theMsg.size()+1, 0, nullptr);
 }
 
 ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg, const long theSeconds, const long theNanoSeconds) {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: sending message " << theMsg << " with a timeout on " << name << "...";
-    #endif
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) return res;
+    return sendData(theMsg.c_str(), theMsg.size()+1, 0, &tm);
+}
 
+ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg, const Deadline& theDeadline) {
     timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) return res;
+    return sendData(theMsg.c_str(), theMsg.size()+1, 0, &tm);
+}
+
+ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg, const Priority& thePriority) {
+    return sendData(theMsg.c_str(), theMsg.size()+1, thePriority.getValue(), nullptr);
+}
+
+ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg, const Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) return res;
+    return sendData(theMsg.c_str(), theMsg.size()+1, thePriority.getValue(), &tm);
+}
+
+ipclib::Result ipclib::MsgQueue::send(const std::string& theMsg, const Priority& thePriority, const Deadline& theDeadline) {
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) return res;
+    return sendData(theMsg.c_str(), theMsg.size()+1, thePriority.getValue(), &tm);
+}
 
-    if(  clock_gettime(CLOCK_REALTIME, &tm) == -1) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer) {
+    return receiveString(theBuffer, nullptr, nullptr);
+}
+
+ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) {
+        theBuffer.clear();
         return res;
     }
 
-    tm.tv_sec = tm.tv_sec + theSeconds;
-    tm.tv_nsec = tm.tv_nsec + theNanoSeconds;
+    return receiveString(theBuffer, nullptr, &tm);
+}
 
-    if( mq_timedsend(msg_queue, theMsg.c_str(), theMsg.size(), 0, &tm) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
-        return Result(Result::SUCCESS);
+ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer, const Deadline& theDeadline) {
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) {
+        theBuffer.clear();
+        return res;
     }
 
-    else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+    return receiveString(theBuffer, nullptr, &tm);
+}
+
+ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer, Priority& thePriority) {
+    unsigned int priority = 0;
+    Result res = receiveString(theBuffer, &priority, nullptr);
+    thePriority = Priority(priority);
+    return res;
+}
+
+ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer, Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) {
+        theBuffer.clear();
         return res;
     }
+
+    unsigned int priority = 0;
+    res = receiveString(theBuffer, &priority, &tm);
+    thePriority = Priority(priority);
+    return res;
 }
 
-ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds) {
-    theBuffer.clear();
+ipclib::Result ipclib::MsgQueue::receive(std::string& theBuffer, Priority& thePriority, const Deadline& theDeadline) {
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) {
+        theBuffer.clear();
+        return res;
+    }
 
-    long buffersize;
-    if( (buffersize = getMaxMsgSize()) == ATTRIBUTE_ERROR ) return Result(ATTRIBUTE_ERROR, "Error in retrieving message buffer size");
-    else buffersize++;
+    unsigned int priority = 0;
+    res = receiveString(theBuffer, &priority, &tm);
+    thePriority = Priority(priority);
+    return res;
+}
 
-    char* buffer = new char[buffersize];
+ipclib::Result ipclib::MsgQueue::sendBytes(const void* theData, const size_t theSize) {
+    return sendData(theData, theSize, 0, nullptr);
+}
 
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: receiving message with a timeout on "<< name << "...";
-    #endif
+ipclib::Result ipclib::MsgQueue::sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) return res;
+    return sendData(theData, theSize, 0, &tm);
+}
 
-       timespec tm;
+ipclib::Result ipclib::MsgQueue::sendBytes(const void* theData, const size_t theSize, const Deadline& theDeadline) {
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) return res;
+    return sendData(theData, theSize, 0, &tm);
+}
 
-    if(  clock_gettime(CLOCK_REALTIME, &tm) == -1) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
-        return res;
-    }
+ipclib::Result ipclib::MsgQueue::sendBytes(const void* theData, const size_t theSize, const Priority& thePriority) {
+    return sendData(theData, theSize, thePriority.getValue(), nullptr);
+}
 
-    tm.tv_sec = tm.tv_sec + theSeconds;
-    tm.tv_nsec = tm.tv_nsec + theNanoSeconds;
+ipclib::Result ipclib::MsgQueue::sendBytes(const void* theData, const size_t theSize, const Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) return res;
+    return sendData(theData, theSize, thePriority.getValue(), &tm);
+}
 
-    if( mq_timedreceive(msg_queue, buffer, buffersize, NULL, &tm) == -1 ) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
-        delete [] buffer;
-        return res;
+ipclib::Result ipclib::MsgQueue::sendBytes(const void* theData, const size_t theSize, const Priority& thePriority, const Deadline& theDeadline) {
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) return res;
+    return sendData(theData, theSize, thePriority.getValue(), &tm);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize) {
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, nullptr, nullptr);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds) {
+    theReceivedSize = 0;
+
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) return res;
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, nullptr, &tm);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const Deadline& theDeadline) {
+    theReceivedSize = 0;
+
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) return res;
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, nullptr, &tm);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, Priority& thePriority) {
+    unsigned int priority = 0;
+    Result res = receiveData(theBuffer, theBufferSize, theReceivedSize, &priority, nullptr);
+    thePriority = Priority(priority);
+    return res;
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+    theReceivedSize = 0;
+
+    timespec tm;
+    Result res = getTimeout(theSeconds, theNanoSeconds, tm);
+    if( !res ) return res;
+
+    unsigned int priority = 0;
+    res = receiveData(theBuffer, theBufferSize, theReceivedSize, &priority, &tm);
+    thePriority = Priority(priority);
+    return res;
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, Priority& thePriority, const Deadline& theDeadline) {
+    theReceivedSize = 0;
+
+    timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( !res ) return res;
+
+    unsigned int priority = 0;
+    res = receiveData(theBuffer, theBufferSize, theReceivedSize, &priority, &tm);
+    thePriority = Priority(priority);
+    return res;
+}
+
+//only the first operation of a batch follows the queue's blocking mode, the others pass an already expired timeout
+//so a full or empty queue ends the batch with EAGAIN instead of blocking halfway through it
+int ipclib::MsgQueue::sendOne(const void* theData, const size_t theSize, const unsigned int thePriority, const bool toBlock) {
+    static const timespec expired = {0, 0};
+
+    if( toBlock ) return mq_send(msg_queue, (const char*)(theData), theSize, thePriority);
+    else return mq_timedsend(msg_queue, (const char*)(theData), theSize, thePriority, &expired);
+}
+
+ssize_t ipclib::MsgQueue::receiveOne(void* theBuffer, unsigned int* thePriority, const bool toBlock) {
+    static const timespec expired = {0, 0};
+
+    if( toBlock ) return mq_receive(msg_queue, (char*)(theBuffer), cached_attribute.mq_msgsize, thePriority);
+    else return mq_timedreceive(msg_queue, (char*)(theBuffer), cached_attribute.mq_msgsize, thePriority, &expired);
+}
+
+ipclib::Result ipclib::MsgQueue::getBatchResult(const TraceOp theOp, const int theError, const size_t theCount) {
+    if( theCount ) {
+        metrics.onOperation(0, theCount);
+        metrics.onDepthChange(theOp == TRACE_MSG_QUEUE_SEND_BATCH ? (int64_t)(theCount) : -(int64_t)(theCount));
     }
 
-    else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
-        theBuffer = buffer;
-        delete [] buffer;
+    if( theError == 0 ) {
+        IPCLIB_TRACE_EVENT(theOp, name, 0, theCount);
         return Result(Result::SUCCESS);
     }
+
+    int error = theError;
+    if( error == ETIMEDOUT ) error = EAGAIN;
+    metrics.onError(error);
+
+    Result res(error);
+    IPCLIB_TRACE_EVENT(theOp, name, res.getError(), theCount);
+    return res;
+}
+
+ipclib::Result ipclib::MsgQueue::sendBatch(const std::vector<std::string>& theMsgs, size_t& theSentCount, const Priority* thePriorities) {
+    int err = 0;
+    for( theSentCount = 0; theSentCount < theMsgs.size(); theSentCount++ ) {
+        const std::string& msg = theMsgs[theSentCount];
+        unsigned int priority = thePriorities ? thePriorities[theSentCount].getValue() : 0;
+        if( sendOne(msg.c_str(), msg.size()+1, priority, theSentCount == 0) == -1 ) {
+            err = errno;
+            break;
+        }
+    }
+
+    return getBatchResult(TRACE_MSG_QUEUE_SEND_BATCH, err, theSentCount);
+}
+
+ipclib::Result ipclib::MsgQueue::sendBatchBytes(const void* const* theData, const size_t* theSizes, const size_t theCount, size_t& theSentCount, const Priority* thePriorities) {
+    int err = 0;
+    for( theSentCount = 0; theSentCount < theCount; theSentCount++ ) {
+        unsigned int priority = thePriorities ? thePriorities[theSentCount].getValue() : 0;
+        if( sendOne(theData[theSentCount], theSizes[theSentCount], priority, theSentCount == 0) == -1 ) {
+            err = errno;
+            break;
+        }
+    }
+
+    return getBatchResult(TRACE_MSG_QUEUE_SEND_BATCH, err, theSentCount);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBatch(std::vector<std::string>& theBuffers, const size_t theMaxCount, size_t& theReceivedCount, Priority* thePriorities) {
+    theReceivedCount = 0;
+    if( cached_attribute.mq_msgsize == ATTRIBUTE_ERROR ) return Result(ATTRIBUTE_ERROR, "Error in retrieving message buffer size");
+
+    //the strings are kept between calls, so once they have grown to mq_msgsize a batch allocates nothing
+    if( theBuffers.size() < theMaxCount ) theBuffers.resize(theMaxCount);
+
+    int err = 0;
+    for( ; theReceivedCount < theMaxCount; theReceivedCount++ ) {
+        std::string& buffer = theBuffers[theReceivedCount];
+        buffer.resize(cached_attribute.mq_msgsize);
+
+        ssize_t received;
+        unsigned int priority;
+        if( (received = receiveOne(&buffer[0], &priority, theReceivedCount == 0)) == -1 ) {
+            err = errno;
+            buffer.clear();
+            break;
+        }
+
+        buffer.resize(strnlen(buffer.data(), received));
+        if( thePriorities ) thePriorities[theReceivedCount] = Priority(priority);
+    }
+
+    return getBatchResult(TRACE_MSG_QUEUE_RECEIVE_BATCH, err, theReceivedCount);
+}
+
+ipclib::Result ipclib::MsgQueue::receiveBatchBytes(void* theBuffer, const size_t theBufferSize, size_t* theSizes, const size_t theMaxCount, size_t& theReceivedCount, Priority* thePriorities) {
+    theReceivedCount = 0;
+    if( cached_attribute.mq_msgsize == ATTRIBUTE_ERROR ) return Result(ATTRIBUTE_ERROR, "Error in retrieving message buffer size");
+
+    //messages are packed back to back, and the batch stops once less than mq_msgsize bytes of the buffer are left
+    char* buffer = (char*)(theBuffer);
+    size_t used = 0;
+    int err = 0;
+    for( ; theReceivedCount < theMaxCount && theBufferSize - used >= (size_t)(cached_attribute.mq_msgsize); theReceivedCount++ ) {
+        ssize_t received;
+        unsigned int priority;
+        if( (received = receiveOne(buffer + used, &priority, theReceivedCount == 0)) == -1 ) {
+            err = errno;
+            break;
+        }
+
+        theSizes[theReceivedCount] = received;
+        if( thePriorities ) thePriorities[theReceivedCount] = Priority(priority);
+        used = used + received;
+    }
+
+    if( theReceivedCount == 0 && err == 0 && theMaxCount > 0 ) err = EMSGSIZE;
+    return getBatchResult(TRACE_MSG_QUEUE_RECEIVE_BATCH, err, theReceivedCount);
+}
+
+ipclib::Result ipclib::MsgQueue::drain(std::vector<std::string>& theBuffers, const size_t theMaxCount, size_t& theReceivedCount, Priority* thePriorities) {
+    theReceivedCount = 0;
+    if( cached_attribute.mq_msgsize == ATTRIBUTE_ERROR ) return Result(ATTRIBUTE_ERROR, "Error in retrieving message buffer size");
+
+    if( theBuffers.size() < theMaxCount ) theBuffers.resize(theMaxCount);
+
+    int err = 0;
+    for( ; theReceivedCount < theMaxCount; theReceivedCount++ ) {
+        std::string& buffer = theBuffers[theReceivedCount];
+        buffer.resize(cached_attribute.mq_msgsize);
+
+        ssize_t received;
+        unsigned int priority;
+        if( (received = receiveOne(&buffer[0], &priority, false)) == -1 ) {
+            err = errno;
+            buffer.clear();
+            break;
+        }
+
+        buffer.resize(strnlen(buffer.data(), received));
+        if( thePriorities ) thePriorities[theReceivedCount] = Priority(priority);
+    }
+
+    //an empty queue is the normal end of a drain, not an error
+    if( err == EAGAIN || err == ETIMEDOUT ) err = 0;
+    return getBatchResult(TRACE_MSG_QUEUE_DRAIN, err, theReceivedCount);
 }
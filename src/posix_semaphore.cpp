@@ -1,10 +1,17 @@
 #include "posix_semaphore.h"
 
+#include <errno.h>
 #include <string.h>
 #include <fcntl.h>
+#include <time.h>
 
-#ifdef NDEBUG
-#include <iostream>
+#include "trace.h"
+
+//sem_clockwait appeared in glibc 2.30, older libraries wait on a deadline converted to CLOCK_REALTIME
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+#define IPCLIB_HAVE_SEM_CLOCKWAIT 1
+#else
+#define IPCLIB_HAVE_SEM_CLOCKWAIT 0
 #endif
 
 ipclib::Semaphore::Semaphore(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const unsigned int theValue) : PosixObject() {
@@ -12,24 +19,16 @@ ipclib::Semaphore::Semaphore(const std::string& theName, const bool toCreate, co
 }
 
 int ipclib::Semaphore::getValue() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: retrieving value for semaphore " << name << "...";
-    #endif
-
     int value;
     if( sem_getvalue(sem, &value) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_GET_VALUE, name, 0, 0);
         if( value <= 0 ) return 0;
         else return value;
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_GET_VALUE, name, res.getError(), 0);
         return -1;
     }
 }
@@ -39,27 +38,19 @@ ipclib::Result ipclib::Semaphore::create(const std::string& theName, const bool
 
     PosixObject::create(theName);
 
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: starting initialization for " << name << "...";
-    #endif
-
     int oflag = 0;
     if( toCreate ) oflag = oflag | O_CREAT;
     if( toCreateExclusively ) oflag = oflag | O_EXCL;
 
     if( (sem = sem_open(posix_name.c_str(), oflag, DEFAULT_PERMISSION, theValue)) == SEM_FAILED ) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_CREATE, name, res.getError(), 0);
         initialization_result = res;
         return initialization_result;
     }
 
     else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_CREATE, name, 0, 0);
 
         initialization_result = Result(Result::SUCCESS);
         return initialization_result;
@@ -67,119 +58,137 @@ ipclib::Result ipclib::Semaphore::create(const std::string& theName, const bool
 }
 
 ipclib::Result ipclib::Semaphore::destroy() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: destroying semaphore " << name << "...";
-    #endif
-
     if( sem_unlink(posix_name.c_str()) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_DESTROY, name, 0, 0);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_DESTROY, name, res.getError(), 0);
         return res;
     }
 }
 
 ipclib::Result ipclib::Semaphore::wait() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: waiting on " << name << "...";
-    #endif
-
-    if( sem_wait(sem) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+    if( spin_policy.spin([this]() { return sem_trywait(sem) == 0; }) ) {
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_WAIT, name, 0, 0);
+        metrics.onOperation();
+        metrics.onDepthChange(-1);
+        return Result(Result::SUCCESS);
+    }
+
+    long blocking_start = spin_policy.startBlocking();
+    long metrics_start = metrics.startBlocking();
+    int err = sem_wait(sem);
+    metrics.stopBlocking(metrics_start);
+    spin_policy.stopBlocking(blocking_start);
+
+    if( err == 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_WAIT, name, 0, 0);
+        metrics.onOperation();
+        metrics.onDepthChange(-1);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_WAIT, name, res.getError(), 0);
+        metrics.onError(res.getError());
         return res;
     }
 }
 
+//relative timeouts are taken on the monotonic clock, so a wall clock jump neither shortens nor stretches them
 ipclib::Result ipclib::Semaphore::wait(const long theSeconds, const long theNanoSeconds) {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: waiting with a timeout on " << name << "...";
-    #endif
+    return wait(Deadline(theSeconds, theNanoSeconds));
+}
+
+ipclib::Result ipclib::Semaphore::wait(const Deadline& theDeadline) {
+    //the deadline is taken before spinning, so the spin budget is part of the timeout
+    if( spin_policy.spin([this]() { return sem_trywait(sem) == 0; }) ) {
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_TIMED_WAIT, name, 0, 0);
+        metrics.onOperation();
+        metrics.onDepthChange(-1);
+        return Result(Result::SUCCESS);
+    }
+
+    long blocking_start = spin_policy.startBlocking();
+    long metrics_start = metrics.startBlocking();
 
+    int err;
+#if IPCLIB_HAVE_SEM_CLOCKWAIT
+    err = sem_clockwait(sem, theDeadline.getClock(), &theDeadline.getTime());
+#else
     timespec tm;
+    Result res = theDeadline.getTime(Deadline::REALTIME, tm);
+    if( res ) err = sem_timedwait(sem, &tm);
+    else {
+        err = -1;
+        errno = res.getError();
+    }
+#endif
 
-    if(  clock_gettime(CLOCK_REALTIME, &tm) == -1) {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
-        return res;
+    metrics.stopBlocking(metrics_start);
+    spin_policy.stopBlocking(blocking_start);
+
+    if( err == 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_TIMED_WAIT, name, 0, 0);
+        metrics.onOperation();
+        metrics.onDepthChange(-1);
+        return Result(Result::SUCCESS);
     }
 
-    tm.tv_sec = tm.tv_sec + theSeconds;
-    tm.tv_nsec = tm.tv_nsec + theNanoSeconds;
+    else {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_TIMED_WAIT, name, res.getError(), 0);
+        metrics.onError(res.getError());
+        return res;
+    }
+}
 
-    if( sem_timedwait(sem, &tm) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+//never blocks, EAGAIN means the semaphore was zero
+ipclib::Result ipclib::Semaphore::tryWait() {
+    if( sem_trywait(sem) == 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_WAIT, name, 0, 0);
+        metrics.onOperation();
+        metrics.onDepthChange(-1);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_WAIT, name, res.getError(), 0);
+        metrics.onError(res.getError());
         return res;
     }
 }
 
 ipclib::Result ipclib::Semaphore::signal() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: signaling on " << name << "...";
-    #endif
-
     if( sem_post(sem) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_SIGNAL, name, 0, 0);
+        metrics.onOperation();
+        metrics.onDepthChange(1);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_SIGNAL, name, res.getError(), 0);
+        metrics.onError(res.getError());
         return res;
     }
 }
 
 ipclib::Result ipclib::Semaphore::deallocateResources() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: deallocating resources for " << name << "...";
-    #endif
-
     if( sem_close(sem) == 0 ) {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_CLOSE, name, 0, 0);
         return Result(Result::SUCCESS);
     }
 
     else {
-        Result res(errno, strerror(errno));
-        #ifdef NDEBUG
-        std::cout << "FAILED with error " << res.getError() << "\n";
-        #endif
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SEMAPHORE_CLOSE, name, res.getError(), 0);
         return res;
     }
 }
@@ -0,0 +1,98 @@
+#include "priority_scheduler.h"
+
+#include <iterator>
+#include <utility>
+
+ipclib::PriorityScheduler::PriorityScheduler(MsgQueue& theQueue, const unsigned int theAgingInterval, const MsgQueue::Priority& theUrgentPriority, const size_t theMaxBuffered) {
+    queue = &theQueue;
+    aging_interval = theAgingInterval > 0 ? theAgingInterval : 1;
+    urgent_priority = theUrgentPriority.getValue();
+    max_buffered = theMaxBuffered > 0 ? theMaxBuffered : 1;
+    buffered = 0;
+    delivered = 0;
+}
+
+//pulls whatever is already waiting in the queue without blocking, the kernel hands it over highest priority first
+ipclib::Result ipclib::PriorityScheduler::refill() {
+    if( buffered >= max_buffered ) return Result(Result::SUCCESS);
+
+    size_t wanted = max_buffered - buffered;
+    if( batch_priorities.size() < wanted ) batch_priorities.resize(wanted);
+
+    size_t count;
+    Result res = queue->drain(batch, wanted, count, &batch_priorities[0]);
+
+    //the slots just emptied get the buffers callers handed back, so the next drain reuses their capacity
+    for( size_t i = 0; i < count; i++ ) {
+        Entry entry;
+        entry.msg.swap(batch[i]);
+        entry.sequence = delivered;
+        bands[batch_priorities[i].getValue()].push_back(std::move(entry));
+
+        if( !spare.empty() ) {
+            batch[i].swap(spare.back());
+            spare.pop_back();
+        }
+    }
+
+    buffered = buffered + count;
+    return res;
+}
+
+void ipclib::PriorityScheduler::pop(std::string& theMsg, MsgQueue::Priority& thePriority) {
+    std::map< unsigned int, std::deque<Entry> >::iterator chosen = bands.end();
+    uint64_t best = 0;
+
+    //bands are walked from the highest priority down, so on a tie the higher priority wins
+    for( std::map< unsigned int, std::deque<Entry> >::reverse_iterator it = bands.rbegin(); it != bands.rend(); ++it ) {
+        if( it->second.empty() ) continue;
+
+        if( it->first >= urgent_priority ) {
+            chosen = std::prev(it.base());
+            break;
+        }
+
+        uint64_t effective = it->first + (delivered - it->second.front().sequence) / aging_interval;
+        if( chosen == bands.end() || effective > best ) {
+            chosen = std::prev(it.base());
+            best = effective;
+        }
+    }
+
+    //the strings are swapped, so a caller reusing theMsg hands its capacity back to the next refill
+    theMsg.swap(chosen->second.front().msg);
+    thePriority = MsgQueue::Priority(chosen->first);
+    spare.push_back(std::move(chosen->second.front().msg));
+    chosen->second.pop_front();
+
+    buffered--;
+    delivered++;
+}
+
+ipclib::Result ipclib::PriorityScheduler::receive(std::string& theMsg, MsgQueue::Priority& thePriority) {
+    Result res = refill();
+    if( !res ) return res;
+
+    if( !buffered ) {
+        res = queue->receive(theMsg, thePriority);
+        if( res ) delivered++;
+        return res;
+    }
+
+    pop(theMsg, thePriority);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::PriorityScheduler::receive(std::string& theMsg, MsgQueue::Priority& thePriority, const long theSeconds, const long theNanoSeconds) {
+    Result res = refill();
+    if( !res ) return res;
+
+    if( !buffered ) {
+        res = queue->receive(theMsg, thePriority, theSeconds, theNanoSeconds);
+        if( res ) delivered++;
+        return res;
+    }
+
+    pop(theMsg, thePriority);
+    return Result(Result::SUCCESS);
+}
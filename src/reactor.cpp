@@ -0,0 +1,114 @@
+#include "reactor.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::Reactor::Reactor() : stopped(false) {
+    if( (epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1 ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_REACTOR_CREATE, "", res.getError(), 0);
+        initialization_result = res;
+        return;
+    }
+
+    Result res = wakeup.create(0, true);
+    if( res ) {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = wakeup.getDescriptor();
+        if( epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup.getDescriptor(), &event) == -1 ) res = Result(errno);
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_REACTOR_CREATE, "", res.getError(), 0);
+    initialization_result = res;
+}
+
+ipclib::Result ipclib::Reactor::deallocateResources() {
+    if( epoll_fd == -1 ) return Result(Result::SUCCESS);
+
+    int fd = epoll_fd;
+    epoll_fd = -1;
+    handlers.clear();
+
+    if( close(fd) == 0 ) return Result(Result::SUCCESS);
+    else return Result(errno);
+}
+
+ipclib::Result ipclib::Reactor::add(const int theDescriptor, const Handler& theHandler, const uint32_t theInterest) {
+    epoll_event event;
+    event.events = theInterest;
+    event.data.fd = theDescriptor;
+
+    if( epoll_ctl(epoll_fd, EPOLL_CTL_ADD, theDescriptor, &event) == -1 ) return Result(errno);
+
+    handlers[theDescriptor] = std::make_shared<Handler>(theHandler);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::Reactor::add(MsgQueue& theQueue, const Handler& theHandler, const uint32_t theInterest) {
+    return add(theQueue.getDescriptor(), theHandler, theInterest);
+}
+
+ipclib::Result ipclib::Reactor::add(Event& theEvent, const Handler& theHandler) {
+    return add(theEvent.getDescriptor(), theHandler, READABLE);
+}
+
+ipclib::Result ipclib::Reactor::modify(const int theDescriptor, const uint32_t theInterest) {
+    epoll_event event;
+    event.events = theInterest;
+    event.data.fd = theDescriptor;
+
+    if( epoll_ctl(epoll_fd, EPOLL_CTL_MOD, theDescriptor, &event) == -1 ) return Result(errno);
+    else return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::Reactor::remove(const int theDescriptor) {
+    handlers.erase(theDescriptor);
+
+    if( epoll_ctl(epoll_fd, EPOLL_CTL_DEL, theDescriptor, NULL) == -1 ) return Result(errno);
+    else return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::Reactor::runOnce(const int theTimeout) {
+    int ready;
+    if( (ready = epoll_wait(epoll_fd, events, MAX_EVENTS, theTimeout)) == -1 ) {
+        if( errno == EINTR ) return Result(Result::SUCCESS);
+        else return Result(errno);
+    }
+
+    for( int i = 0; i < ready; i++ ) {
+        int fd = events[i].data.fd;
+
+        if( fd == wakeup.getDescriptor() ) {
+            wakeup.consume();
+            continue;
+        }
+
+        //the handler is looked up per event and kept alive while it runs, so handlers may remove themselves or others
+        std::map< int, std::shared_ptr<Handler> >::iterator it = handlers.find(fd);
+        if( it == handlers.end() ) continue;
+
+        std::shared_ptr<Handler> handler = it->second;
+        (*handler)(events[i].events);
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::Reactor::run() {
+    IPCLIB_TRACE_EVENT(TRACE_REACTOR_RUN, "", 0, handlers.size());
+
+    Result res(Result::SUCCESS);
+    while( res && !stopped.load(std::memory_order_acquire) ) res = runOnce();
+
+    stopped.store(false, std::memory_order_relaxed);
+    return res;
+}
+
+ipclib::Result ipclib::Reactor::stop() {
+    stopped.store(true, std::memory_order_release);
+    return wakeup.signal();
+}
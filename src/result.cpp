@@ -1,8 +1,28 @@
 #include "result.h"
 
 #include <string>
+#include <string.h>
 
-ipclib::Result::Result(const int theError, const std::string& theDescription) {
-    error = theError;
-    description = theDescription;
+namespace {
+
+    //strerror_r is either the XSI version returning an int or the GNU one returning the string
+    inline const char* getErrorString(const int theResult, const char* theBuffer) {
+        if( theResult == 0 ) return theBuffer;
+        else return "Unknown error";
+    }
+
+    inline const char* getErrorString(const char* theResult, const char*) {
+        return theResult;
+    }
+
+}
+
+std::string ipclib::Result::getDescription() const {
+    if( message ) return message;
+    if( error == SUCCESS ) return "Success";
+    if( error < 0 ) return "ipclib error " + std::to_string(error);
+
+    char buffer[256];
+    buffer[0] = '\0';
+    return getErrorString(strerror_r(error, buffer, sizeof(buffer)), buffer);
 }
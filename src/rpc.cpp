@@ -0,0 +1,395 @@
+#include "rpc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+
+    long long getNanoSeconds(const timespec& theTime) {
+        return (long long)(theTime.tv_sec) * 1000000000LL + theTime.tv_nsec;
+    }
+
+    std::string getMessage(const ipclib::RpcHeader& theHeader, const std::string& thePayload) {
+        std::string message(sizeof(ipclib::RpcHeader) + thePayload.size(), '\0');
+        memcpy(&message[0], &theHeader, sizeof(ipclib::RpcHeader));
+        if( !thePayload.empty() ) memcpy(&message[sizeof(ipclib::RpcHeader)], thePayload.data(), thePayload.size());
+        return message;
+    }
+
+}
+
+ipclib::RpcServer::RpcServer(ThreadPool& thePool, const std::string& theName, const long theMaxMsg, const long theMaxPayloadSize) : stopped(false) {
+    pool = &thePool;
+    create(theName, theMaxMsg, theMaxPayloadSize);
+}
+
+ipclib::Result ipclib::RpcServer::create(const std::string& theName, const long theMaxMsg, const long theMaxPayloadSize) {
+    name = theName;
+    initialization_result = requests.create(theName, true, false, false, MsgQueue::READ_AND_WRITE, theMaxMsg, sizeof(RpcHeader) + theMaxPayloadSize);
+    if( initialization_result.getError() == EINVAL ) initialization_result.setDescription("The header plus theMaxPayloadSize or theMaxMsg exceed /proc/sys/fs/mqueue/msgsize_max or msg_max");
+    return initialization_result;
+}
+
+//reply queues are opened on the first reply to a client and closed when it says goodbye or a reply to it fails
+//the open happens under the lock: a client unlinks its queue before saying goodbye, so it can never be cached again
+std::shared_ptr<ipclib::MsgQueue> ipclib::RpcServer::getReplyQueue(const uint64_t theClient) {
+    reply_lock.lock();
+    std::map< uint64_t, std::shared_ptr<MsgQueue> >::iterator it = reply_queues.find(theClient);
+    if( it != reply_queues.end() ) {
+        std::shared_ptr<MsgQueue> queue = it->second;
+        reply_lock.unlock();
+        return queue;
+    }
+
+    std::shared_ptr<MsgQueue> queue = std::make_shared<MsgQueue>(RpcClient::getReplyQueueName(name, theClient), false);
+    if( queue->getInitializationResult() ) reply_queues[theClient] = queue;
+    else queue.reset();
+
+    reply_lock.unlock();
+    return queue;
+}
+
+//an empty theQueue drops whatever is cached for theClient, workers still replying keep their copy until they are done
+void ipclib::RpcServer::dropReplyQueue(const uint64_t theClient, const std::shared_ptr<MsgQueue>& theQueue) {
+    std::shared_ptr<MsgQueue> dropped;
+
+    reply_lock.lock();
+    std::map< uint64_t, std::shared_ptr<MsgQueue> >::iterator it = reply_queues.find(theClient);
+    if( it != reply_queues.end() && (!theQueue || it->second == theQueue) ) {
+        dropped.swap(it->second);
+        reply_queues.erase(it);
+    }
+    reply_lock.unlock();
+}
+
+void ipclib::RpcServer::reply(const RpcHeader& theHeader, const Result& theResult, const std::string& thePayload) {
+    std::shared_ptr<MsgQueue> queue = getReplyQueue(theHeader.client);
+    if( !queue ) return;
+
+    RpcHeader header = theHeader;
+    header.status = theResult.getError();
+    header.size = thePayload.size();
+    std::string message = getMessage(header, thePayload);
+
+    //a client which stopped reading must not hold a worker for longer than REPLY_TIMEOUT
+    if( !queue->sendBytes(message.data(), message.size(), REPLY_TIMEOUT) ) dropReplyQueue(theHeader.client, queue);
+}
+
+void ipclib::RpcServer::dispatch(const RpcHeader& theHeader, const std::string& theRequest) {
+    std::string payload;
+    Result res;
+
+    std::map<uint32_t, Handler>::const_iterator handler = handlers.find(theHeader.method);
+    if( handler == handlers.end() ) res = Result(ENOSYS);
+    else {
+        try {
+            res = handler->second(theRequest, payload);
+        }
+
+        catch( ... ) {
+            res = Result(ECANCELED, "Handler threw an exception");
+            payload.clear();
+        }
+    }
+
+    if( payload.size() > (size_t)(getMaxPayloadSize()) ) {
+        res = Result(EMSGSIZE);
+        payload.clear();
+    }
+
+    reply(theHeader, res, payload);
+}
+
+ipclib::Result ipclib::RpcServer::run() {
+    if( !initialization_result ) return initialization_result;
+
+    std::vector<char> buffer(requests.getMaxMsgSize());
+
+    Result res(Result::SUCCESS);
+    while( !stopped.load(std::memory_order_acquire) ) {
+        size_t received;
+        res = requests.receiveBytes(buffer.data(), buffer.size(), received);
+        if( !res ) {
+            if( res.getError() == EINTR ) {
+                res = Result(Result::SUCCESS);
+                continue;
+            }
+
+            break;
+        }
+
+        if( received < sizeof(RpcHeader) ) continue;
+
+        RpcHeader header;
+        memcpy(&header, buffer.data(), sizeof(RpcHeader));
+        if( !header.client ) continue;
+
+        if( !header.correlation_id ) {
+            dropReplyQueue(header.client, std::shared_ptr<MsgQueue>());
+            continue;
+        }
+
+        //the client would otherwise only hear about a refused request when its deadline passes
+        std::string request(buffer.data() + sizeof(RpcHeader), std::min((size_t)(header.size), received - sizeof(RpcHeader)));
+        Result posted = pool->post([this, header, request]() { dispatch(header, request); });
+        if( !posted ) reply(header, posted, std::string());
+    }
+
+    stopped.store(false, std::memory_order_relaxed);
+    return res;
+}
+
+//a header without a client only wakes run() up, it is never dispatched
+//the wakeup may wait for room while run() drains a full queue, it only fails if nothing is read for REPLY_TIMEOUT
+ipclib::Result ipclib::RpcServer::stop() {
+    stopped.store(true, std::memory_order_release);
+
+    RpcHeader wakeup;
+    memset(&wakeup, 0, sizeof(RpcHeader));
+    return requests.sendBytes(&wakeup, sizeof(RpcHeader), REPLY_TIMEOUT);
+}
+
+ipclib::RpcClient::RpcClient(const std::string& theName, const long theMaxMsg) : receiver_running(false), stopping(false), next_id(1) {
+    client = 0;
+    receiving = false;
+    create(theName, theMaxMsg);
+}
+
+std::string ipclib::RpcClient::getReplyQueueName(const std::string& theName, const uint64_t theClient) {
+    return theName + ".reply." + std::to_string(theClient);
+}
+
+size_t ipclib::RpcClient::getPendingNumber() {
+    lock.lock();
+    size_t number = pending.size();
+    lock.unlock();
+    return number;
+}
+
+ipclib::Result ipclib::RpcClient::create(const std::string& theName, const long theMaxMsg) {
+    static std::atomic<uint32_t> instances(0);
+
+    close();
+
+    client = ((uint64_t)(getpid()) << 24) | (instances.fetch_add(1, std::memory_order_relaxed) & 0xFFFFFF);
+
+    //the request queue belongs to the server, it only gets opened here
+    Result res = requests.create(theName, false);
+    if( res ) res = replies.create(getReplyQueueName(theName, client), true, true, false, MsgQueue::READ_AND_WRITE, theMaxMsg, requests.getMaxMsgSize());
+
+    if( res ) {
+        stopping.store(false, std::memory_order_relaxed);
+        receiving = true;
+        res = receiver.run(receiverMain, this);
+        receiver_running.store(res, std::memory_order_release);
+        if( !res ) {
+            receiving = false;
+            replies.destroy();
+        }
+    }
+
+    initialization_result = res;
+    return initialization_result;
+}
+
+ipclib::Result ipclib::RpcClient::close() {
+    if( !receiver_running.load(std::memory_order_acquire) ) return Result(Result::SUCCESS);
+
+    stopping.store(true, std::memory_order_release);
+
+    RpcHeader wakeup;
+    memset(&wakeup, 0, sizeof(RpcHeader));
+    //even when the wakeup finds no room the receiver is not asleep, it sees stopping with the next reply it takes
+    replies.sendBytes(&wakeup, sizeof(RpcHeader), CLOSE_TIMEOUT);
+    Result res = receiver.join();
+    receiver_running.store(false, std::memory_order_release);
+
+    //the queue is unlinked before the goodbye, so the server can not reopen it once it has closed its own descriptor
+    Result destroyed = replies.destroy();
+
+    RpcHeader goodbye;
+    memset(&goodbye, 0, sizeof(RpcHeader));
+    goodbye.client = client;
+    requests.sendBytes(&goodbye, sizeof(RpcHeader), CLOSE_TIMEOUT);
+
+    return !res ? res : destroyed;
+}
+
+void* ipclib::RpcClient::receiverMain(void* theClient) {
+    ((RpcClient*)(theClient))->receiveReplies();
+    return nullptr;
+}
+
+void ipclib::RpcClient::complete(const uint64_t theId, const RpcReply& theReply) {
+    lock.lock();
+    std::map<uint64_t, Pending>::iterator it = pending.find(theId);
+    if( it == pending.end() ) {
+        lock.unlock();
+        return;
+    }
+
+    std::promise<RpcReply> promise = std::move(it->second.promise);
+    if( it->second.expiry != expiries.end() ) expiries.erase(it->second.expiry);
+    pending.erase(it);
+    lock.unlock();
+
+    promise.set_value(theReply);
+}
+
+void ipclib::RpcClient::expire() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    std::vector< std::promise<RpcReply> > expired;
+
+    lock.lock();
+    while( !expiries.empty() && expiries.begin()->first <= getNanoSeconds(now) ) {
+        std::map<uint64_t, Pending>::iterator it = pending.find(expiries.begin()->second);
+        expired.push_back(std::move(it->second.promise));
+        pending.erase(it);
+        expiries.erase(expiries.begin());
+    }
+    lock.unlock();
+
+    RpcReply reply;
+    reply.result = Result(ETIMEDOUT);
+    for( size_t i = 0; i < expired.size(); i++ ) expired[i].set_value(reply);
+}
+
+//with no pipelined deadline to watch the thread sleeps in mq_receive, send() wakes it up when the first one shows up
+void ipclib::RpcClient::receiveReplies() {
+    std::vector<char> buffer(replies.getMaxMsgSize());
+
+    while( !stopping.load(std::memory_order_acquire) ) {
+        lock.lock();
+        bool idle = expiries.empty();
+        lock.unlock();
+
+        size_t received;
+        Result res;
+        if( idle ) res = replies.receiveBytes(buffer.data(), buffer.size(), received);
+        else res = replies.receiveBytes(buffer.data(), buffer.size(), received, 0, EXPIRY_INTERVAL);
+
+        if( res && received >= sizeof(RpcHeader) ) {
+            RpcHeader header;
+            memcpy(&header, buffer.data(), sizeof(RpcHeader));
+
+            if( header.correlation_id ) {
+                RpcReply reply;
+                reply.result = Result(header.status);
+                reply.payload.assign(buffer.data() + sizeof(RpcHeader), std::min((size_t)(header.size), received - sizeof(RpcHeader)));
+                complete(header.correlation_id, reply);
+            }
+        }
+
+        else if( !res && res.getError() != ETIMEDOUT && res.getError() != EINTR ) break;
+
+        expire();
+    }
+
+    //whatever is still outstanding will never be answered through this queue again, nor will anything sent from now on
+    lock.lock();
+    receiving = false;
+    std::map<uint64_t, Pending> cancelled;
+    cancelled.swap(pending);
+    expiries.clear();
+    lock.unlock();
+
+    RpcReply reply;
+    reply.result = Result(ECANCELED);
+    for( std::map<uint64_t, Pending>::iterator it = cancelled.begin(); it != cancelled.end(); ++it ) it->second.promise.set_value(reply);
+}
+
+//requests are registered before they are sent, so a fast reply always finds its future
+ipclib::Result ipclib::RpcClient::send(const uint32_t theMethod, const std::string& theRequest, const Deadline& theDeadline, const bool toExpire, std::future<RpcReply>& theFuture, uint64_t& theId) {
+    if( !receiver_running.load(std::memory_order_acquire) ) return Result(EBADF);
+    if( theRequest.size() > (size_t)(getMaxPayloadSize()) ) return Result(EMSGSIZE);
+
+    RpcHeader header;
+    memset(&header, 0, sizeof(RpcHeader));
+    header.correlation_id = next_id.fetch_add(1, std::memory_order_relaxed);
+    header.client = client;
+    header.method = theMethod;
+    header.size = theRequest.size();
+    std::string message = getMessage(header, theRequest);
+
+    theId = header.correlation_id;
+
+    lock.lock();
+    if( !receiving ) {
+        lock.unlock();
+        return Result(ECANCELED, "The reply receiver stopped, the client has to be created again");
+    }
+
+    bool wake = toExpire && expiries.empty();
+    Pending& entry = pending[theId];
+    entry.expiry = toExpire ? expiries.insert(std::make_pair(getNanoSeconds(theDeadline.getTime()), theId)) : expiries.end();
+    theFuture = entry.promise.get_future();
+    lock.unlock();
+
+    //a full reply queue only delays the wakeup, the receiver drains it and makes room before it sleeps again
+    if( wake ) {
+        RpcHeader wakeup;
+        memset(&wakeup, 0, sizeof(RpcHeader));
+        replies.sendBytes(&wakeup, sizeof(RpcHeader), theDeadline);
+    }
+
+    Result res = requests.sendBytes(message.data(), message.size(), theDeadline);
+    if( !res ) {
+        lock.lock();
+        std::map<uint64_t, Pending>::iterator it = pending.find(theId);
+        if( it != pending.end() ) {
+            if( it->second.expiry != expiries.end() ) expiries.erase(it->second.expiry);
+            pending.erase(it);
+        }
+        lock.unlock();
+    }
+
+    return res;
+}
+
+std::future<ipclib::RpcReply> ipclib::RpcClient::call(const uint32_t theMethod, const std::string& theRequest, const long theSeconds, const long theNanoSeconds) {
+    std::future<RpcReply> future;
+    uint64_t id;
+
+    Result res = send(theMethod, theRequest, Deadline(theSeconds, theNanoSeconds), true, future, id);
+    if( !res ) {
+        RpcReply reply;
+        reply.result = res;
+
+        std::promise<RpcReply> failed;
+        failed.set_value(reply);
+        return failed.get_future();
+    }
+
+    return future;
+}
+
+//the caller waits on its own deadline, so nothing is left for the receiver thread to expire
+ipclib::Result ipclib::RpcClient::call(const uint32_t theMethod, const std::string& theRequest, std::string& theReply, const long theSeconds, const long theNanoSeconds) {
+    Deadline deadline(theSeconds, theNanoSeconds);
+    std::future<RpcReply> future;
+    uint64_t id;
+
+    Result res = send(theMethod, theRequest, deadline, false, future, id);
+    if( !res ) return res;
+
+    //steady_clock is CLOCK_MONOTONIC, the clock the deadline was taken on
+    std::chrono::steady_clock::time_point until(std::chrono::seconds(deadline.getTime().tv_sec) + std::chrono::nanoseconds(deadline.getTime().tv_nsec));
+    if( future.wait_until(until) == std::future_status::timeout ) {
+        lock.lock();
+        bool expired = pending.erase(id) > 0;
+        lock.unlock();
+
+        if( expired ) return Result(ETIMEDOUT);
+    }
+
+    RpcReply reply = future.get();
+    theReply.swap(reply.payload);
+    return reply.result;
+}
@@ -0,0 +1,131 @@
+#include "shared_arena.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::SharedArena::SharedArena(const std::string& theName, const size_t theSize, const bool toCreate, const bool toCreateExclusively, const MappingOptions& theOptions) : PosixObject() {
+    header = nullptr;
+    create(theName, theSize, toCreate, toCreateExclusively, theOptions);
+}
+
+ipclib::Result ipclib::SharedArena::create(const std::string& theName, const size_t theSize, const bool toCreate, const bool toCreateExclusively, const MappingOptions& theOptions) {
+    if( already_initialized ) deallocateResources();
+
+    PosixObject::create(theName);
+
+    if( toCreate && (theSize <= sizeof(Header) || theSize > OFFSET_MASK) ) {
+        Result res(EINVAL);
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_ARENA_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    Result res = region.create(theName, theSize, toCreate, toCreateExclusively, SharedRegion::READ_AND_WRITE, theOptions);
+    if( !res ) {
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_ARENA_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    header = (Header*)(region.getAddress());
+
+    if( region.isOwner() ) {
+        header->size = region.getSize();
+        header->root.store(0, std::memory_order_relaxed);
+        header->top.store((sizeof(Header) + 15) & ~(uint64_t)(15), std::memory_order_relaxed);
+        for( unsigned int i = 0; i < SIZE_CLASSES; i++ ) header->free_lists[i].store(0, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    else {
+        int attempts = 0;
+        while( region.getSize() >= sizeof(Header) && header->magic.load(std::memory_order_acquire) != MAGIC && attempts++ < 1000 ) usleep(100);
+
+        if( region.getSize() < sizeof(Header) || header->magic.load(std::memory_order_acquire) != MAGIC || header->size > region.getSize() ) {
+            res = Result(EAGAIN, "Arena is still being initialized");
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_ARENA_CREATE, name, res.getError(), 0);
+            deallocateResources();
+            initialization_result = res;
+            return initialization_result;
+        }
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_SHARED_ARENA_CREATE, name, 0, 0);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::SharedArena::deallocateResources() {
+    header = nullptr;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::SharedArena::destroy() {
+    return region.destroy();
+}
+
+void* ipclib::SharedArena::getRoot() const {
+    if( !header ) return nullptr;
+
+    uint64_t offset = header->root.load(std::memory_order_acquire);
+    if( !offset ) return nullptr;
+    return (char*)(header) + offset;
+}
+
+void ipclib::SharedArena::setRoot(void* theRoot) {
+    if( !header ) return;
+
+    if( theRoot ) header->root.store((char*)(theRoot) - (char*)(header), std::memory_order_release);
+    else header->root.store(0, std::memory_order_release);
+}
+
+//every block is a power of two with a 16 byte Block in front, freed blocks go on a per class lock-free stack
+//the stack heads carry a 24 bit tag above the 40 bit offset so a pop racing with a pop-and-push can not succeed
+void* ipclib::SharedArena::allocate(Header* theHeader, const size_t theSize) {
+    static_assert(sizeof(Block) == ALIGNMENT, "the Block header sets the alignment of every allocation");
+    unsigned int size_class = MIN_CLASS;
+    while( size_class < SIZE_CLASSES && ((uint64_t)(1) << size_class) < theSize + sizeof(Block) ) size_class++;
+    if( size_class >= SIZE_CLASSES ) return nullptr;
+
+    char* base = (char*)(theHeader);
+    std::atomic<uint64_t>& free_list = theHeader->free_lists[size_class];
+
+    uint64_t head = free_list.load(std::memory_order_acquire);
+    while( head & OFFSET_MASK ) {
+        Block* block = (Block*)(base + (head & OFFSET_MASK));
+        uint64_t next = ((head & ~OFFSET_MASK) + (OFFSET_MASK + 1)) | block->next;
+
+        if( free_list.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire) ) return (char*)(block) + sizeof(Block);
+    }
+
+    uint64_t block_size = (uint64_t)(1) << size_class;
+    uint64_t top = theHeader->top.load(std::memory_order_relaxed);
+    do {
+        if( top + block_size > theHeader->size ) return nullptr;
+    } while( !theHeader->top.compare_exchange_weak(top, top + block_size, std::memory_order_relaxed) );
+
+    Block* block = (Block*)(base + top);
+    block->size_class = size_class;
+    block->magic = MAGIC;
+    block->next = 0;
+    return (char*)(block) + sizeof(Block);
+}
+
+void ipclib::SharedArena::deallocate(Header* theHeader, void* theAddress) {
+    if( !theAddress ) return;
+
+    char* base = (char*)(theHeader);
+    Block* block = (Block*)((char*)(theAddress) - sizeof(Block));
+    if( block->magic != MAGIC || block->size_class >= SIZE_CLASSES ) return;
+
+    std::atomic<uint64_t>& free_list = theHeader->free_lists[block->size_class];
+    uint64_t offset = (char*)(block) - base;
+
+    uint64_t head = free_list.load(std::memory_order_relaxed);
+    do {
+        block->next = head & OFFSET_MASK;
+    } while( !free_list.compare_exchange_weak(head, ((head & ~OFFSET_MASK) + (OFFSET_MASK + 1)) | offset, std::memory_order_release, std::memory_order_relaxed) );
+}
@@ -0,0 +1,147 @@
+#include "shared_region.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::SharedRegion::SharedRegion(const std::string& theName, const size_t theSize, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection, const MappingOptions& theOptions) : PosixObject() {
+    address = nullptr;
+    size = 0;
+    owner = false;
+    create(theName, theSize, toCreate, toCreateExclusively, theProtection, theOptions);
+}
+
+ipclib::Result ipclib::SharedRegion::create(const std::string& theName, const size_t theSize, const bool toCreate, const bool toCreateExclusively, const Protection& theProtection, const MappingOptions& theOptions) {
+    if( already_initialized ) deallocateResources();
+
+    PosixObject::create(theName);
+
+    protection = theProtection;
+    owner = false;
+
+    int oflag;
+    if( theProtection == READ_ONLY ) oflag = O_RDONLY;
+    else oflag = O_RDWR;
+
+    //only the process whose exclusive open succeeds sizes the segment, the others take the size it chose from fstat
+    int fd = -1;
+    if( toCreate && theSize > 0 ) {
+        if( (fd = theOptions.openSegment(posix_name, oflag | O_CREAT | O_EXCL, DEFAULT_PERMISSION, file_path)) >= 0 ) owner = true;
+        else if( errno == EEXIST && !toCreateExclusively ) fd = theOptions.openSegment(posix_name, oflag, DEFAULT_PERMISSION, file_path);
+    }
+
+    else fd = theOptions.openSegment(posix_name, oflag, DEFAULT_PERMISSION, file_path);
+
+    if( fd < 0 ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    if( owner ) {
+        size = MappingOptions::getSegmentSize(fd, theSize, file_path);
+
+        if( ftruncate(fd, size) == -1 ) {
+            Result res(errno);
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, res.getError(), 0);
+            close(fd);
+            MappingOptions::unlinkSegment(posix_name, file_path);
+            owner = false;
+            size = 0;
+            initialization_result = res;
+            return initialization_result;
+        }
+    }
+
+    else {
+        struct stat st;
+        st.st_size = 0;
+        for( int i = 0; fstat(fd, &st) == 0 && st.st_size == 0 && i < SIZE_POLL_ATTEMPTS; i++ ) usleep(SIZE_POLL_INTERVAL);
+
+        if( st.st_size == 0 ) {
+            Result res(EAGAIN, "Shared region has not been sized by its creator yet");
+            IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, res.getError(), 0);
+            close(fd);
+            initialization_result = res;
+            return initialization_result;
+        }
+
+        size = st.st_size;
+    }
+
+    int prot;
+    if( theProtection == READ_ONLY ) prot = PROT_READ;
+    else if( theProtection == WRITE_ONLY ) prot = PROT_WRITE;
+    else prot = PROT_READ | PROT_WRITE;
+
+    if( (address = mmap(NULL, size, prot, theOptions.getMmapFlags(), fd, 0)) == MAP_FAILED ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, res.getError(), 0);
+        address = nullptr;
+        size = 0;
+        close(fd);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    if( close(fd) == -1 ) {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    //a mapping which did not get the options it asked for is not kept half set up
+    Result res = theOptions.apply(address, size, file_path);
+    if( !res ) {
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, res.getError(), 0);
+        munmap(address, size);
+        address = nullptr;
+        size = 0;
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CREATE, name, 0, 0);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::SharedRegion::deallocateResources() {
+    if( !address ) return Result(Result::SUCCESS);
+
+    void* mapping = address;
+    address = nullptr;
+
+    if( munmap(mapping, size) == 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CLOSE, name, 0, 0);
+        size = 0;
+        return Result(Result::SUCCESS);
+    }
+
+    else {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_CLOSE, name, res.getError(), 0);
+        size = 0;
+        return res;
+    }
+}
+
+ipclib::Result ipclib::SharedRegion::destroy() {
+    if( MappingOptions::unlinkSegment(posix_name, file_path) == 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_DESTROY, name, 0, 0);
+        return Result(Result::SUCCESS);
+    }
+
+    else {
+        Result res(errno);
+        IPCLIB_TRACE_EVENT(TRACE_SHARED_REGION_DESTROY, name, res.getError(), 0);
+        return res;
+    }
+}
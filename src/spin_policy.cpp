@@ -0,0 +1,58 @@
+#include "spin_policy.h"
+
+#include <unistd.h>
+
+ipclib::SpinPolicy::SpinPolicy(const long theMaxSpinNanoSeconds, const bool isAdaptive) : budget(0) {
+    //on a single cpu the other side can not make progress while we spin
+    static const long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    max_spin = online_cpus > 1 ? theMaxSpinNanoSeconds : 0;
+    adaptive = isAdaptive;
+    budget.store(max_spin, std::memory_order_relaxed);
+}
+
+ipclib::SpinPolicy::SpinPolicy(const SpinPolicy& thePolicy) : budget(thePolicy.getBudget()) {
+    max_spin = thePolicy.max_spin;
+    adaptive = thePolicy.adaptive;
+}
+
+ipclib::SpinPolicy& ipclib::SpinPolicy::operator=(const SpinPolicy& thePolicy) {
+    max_spin = thePolicy.max_spin;
+    adaptive = thePolicy.adaptive;
+    budget.store(thePolicy.getBudget(), std::memory_order_relaxed);
+    return *this;
+}
+
+long ipclib::SpinPolicy::now() {
+    timespec tm;
+    clock_gettime(CLOCK_MONOTONIC, &tm);
+    return tm.tv_sec * 1000000000L + tm.tv_nsec;
+}
+
+void ipclib::SpinPolicy::stopBlocking(const long theStart) {
+    if( adaptive ) onBlocked(now() - theStart);
+}
+
+//the budget follows twice the recent wait times with a 1/8 moving average, but never exceeds max_spin
+void ipclib::SpinPolicy::adapt(const long theTarget) {
+    long current = getBudget();
+    long next = current + (theTarget - current) / 8;
+    if( next == current ) next = theTarget;
+    budget.store(next, std::memory_order_relaxed);
+}
+
+void ipclib::SpinPolicy::onSpinSuccess(const long theElapsed) {
+    if( !adaptive ) return;
+
+    if( theElapsed * 2 < max_spin ) adapt(theElapsed * 2);
+    else adapt(max_spin);
+}
+
+//a blocking wait which ended within max_spin would have been cheaper as a spin, anything longer shrinks the budget
+void ipclib::SpinPolicy::onBlocked(const long theElapsed) {
+    if( !adaptive ) return;
+
+    if( theElapsed * 2 < max_spin ) adapt(theElapsed * 2);
+    else if( theElapsed < max_spin ) adapt(max_spin);
+    else adapt(0);
+}
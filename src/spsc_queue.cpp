@@ -0,0 +1,233 @@
+#include "spsc_queue.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+ipclib::SpscQueue::SpscQueue(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theMaxMsgSize) : PosixObject() {
+    header = nullptr;
+    slots = nullptr;
+    create(theName, toCreate, toCreateExclusively, isNonBlocking, theMaxMsg, theMaxMsgSize);
+}
+
+long ipclib::SpscQueue::getMsgNumber() const {
+    if( !header ) return -1;
+
+    //tail first, head only moves forward so it can not end up behind the tail read before it
+    uint32_t tail = header->tail.load(std::memory_order_acquire);
+    uint32_t head = header->head.load(std::memory_order_acquire);
+    return head - tail;
+}
+
+ipclib::Result ipclib::SpscQueue::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theMaxMsgSize) {
+    if( already_initialized ) deallocateResources();
+
+    PosixObject::create(theName);
+
+    non_blocking = isNonBlocking;
+
+    if( theMaxMsg <= 0 || theMaxMsg > (1L << 30) || theMaxMsgSize <= 0 || theMaxMsgSize > (1L << 30) ) {
+        Result res(EINVAL);
+        IPCLIB_TRACE_EVENT(TRACE_SPSC_QUEUE_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    uint32_t capacity = 1;
+    while( capacity < (uint32_t)(theMaxMsg) ) capacity = capacity << 1;
+    uint32_t slot_size = ((sizeof(uint32_t) + theMaxMsgSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+
+    //only the process which actually creates the segment lays out the header, everyone else waits for the magic number
+    Result res = region.create(theName, sizeof(Header) + (size_t)(capacity) * slot_size, toCreate, toCreateExclusively);
+    if( !res ) {
+        IPCLIB_TRACE_EVENT(TRACE_SPSC_QUEUE_CREATE, name, res.getError(), 0);
+        initialization_result = res;
+        return initialization_result;
+    }
+
+    bool owner = region.isOwner();
+    header = (Header*)(region.getAddress());
+    slots = region.getData() + sizeof(Header);
+
+    if( owner ) {
+        header->capacity = capacity;
+        header->max_msg_size = theMaxMsgSize;
+        header->slot_size = slot_size;
+        header->head.store(0, std::memory_order_relaxed);
+        header->consumer_waiting.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+        header->producer_waiting.store(0, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    else {
+        int attempts = 0;
+        while( region.getSize() >= sizeof(Header) && header->magic.load(std::memory_order_acquire) != MAGIC && attempts++ < 1000 ) usleep(100);
+
+        if( region.getSize() < sizeof(Header) || header->magic.load(std::memory_order_acquire) != MAGIC || sizeof(Header) + (size_t)(header->capacity) * header->slot_size > region.getSize() ) {
+            res = Result(EAGAIN, "Queue is still being initialized");
+            IPCLIB_TRACE_EVENT(TRACE_SPSC_QUEUE_CREATE, name, res.getError(), 0);
+            deallocateResources();
+            initialization_result = res;
+            return initialization_result;
+        }
+    }
+
+    cached_head = header->head.load(std::memory_order_acquire);
+    cached_tail = header->tail.load(std::memory_order_acquire);
+
+    IPCLIB_TRACE_EVENT(TRACE_SPSC_QUEUE_CREATE, name, 0, 0);
+    initialization_result = Result(Result::SUCCESS);
+    return initialization_result;
+}
+
+ipclib::Result ipclib::SpscQueue::deallocateResources() {
+    header = nullptr;
+    slots = nullptr;
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::SpscQueue::destroy() {
+    return region.destroy();
+}
+
+ipclib::Result ipclib::SpscQueue::waitFor(std::atomic<uint32_t>& theCounter, std::atomic<uint32_t>& theWaitingFlag, const uint32_t theValue, const timespec* theDeadline) {
+    if( non_blocking ) return Result(EAGAIN);
+
+    for( unsigned int i = 0; i < SPIN_COUNT; i++ ) {
+        if( theCounter.load(std::memory_order_acquire) != theValue ) return Result(Result::SUCCESS);
+        cpuRelax();
+    }
+
+    //the flag store and the counter reload pair with the fence on the other side, so a wakeup can not be lost
+    while( theCounter.load(std::memory_order_acquire) == theValue ) {
+        theWaitingFlag.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if( theCounter.load(std::memory_order_acquire) != theValue ) break;
+
+        int err = futexWait(&theCounter, theValue, theDeadline);
+        if( err == ETIMEDOUT ) return Result(ETIMEDOUT);
+        if( err != 0 && err != EAGAIN && err != EINTR ) return Result(err);
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::SpscQueue::sendData(const void* theData, const size_t theSize, const timespec* theDeadline) {
+    if( !header ) return Result(EBADF);
+    if( theSize > header->max_msg_size ) return Result(EMSGSIZE);
+
+    uint32_t head = header->head.load(std::memory_order_relaxed);
+
+    //the consumer's tail is only reloaded once the locally cached copy says the ring is full
+    while( head - cached_tail >= header->capacity ) {
+        cached_tail = header->tail.load(std::memory_order_acquire);
+        if( head - cached_tail < header->capacity ) break;
+
+        Result res = waitFor(header->tail, header->producer_waiting, cached_tail, theDeadline);
+        if( !res ) return res;
+    }
+
+    char* slot = getSlot(head);
+    uint32_t size = theSize;
+    memcpy(slot, &size, sizeof(uint32_t));
+    memcpy(slot + sizeof(uint32_t), theData, theSize);
+
+    header->head.store(head + 1, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( header->consumer_waiting.load(std::memory_order_relaxed) ) {
+        header->consumer_waiting.store(0, std::memory_order_relaxed);
+        futexWake(&header->head);
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::SpscQueue::receiveData(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const timespec* theDeadline) {
+    theReceivedSize = 0;
+    if( !header ) return Result(EBADF);
+
+    uint32_t tail = header->tail.load(std::memory_order_relaxed);
+
+    while( cached_head == tail ) {
+        cached_head = header->head.load(std::memory_order_acquire);
+        if( cached_head != tail ) break;
+
+        Result res = waitFor(header->head, header->consumer_waiting, tail, theDeadline);
+        if( !res ) return res;
+    }
+
+    const char* slot = getSlot(tail);
+    uint32_t size;
+    memcpy(&size, slot, sizeof(uint32_t));
+
+    //like mq_receive, a message which does not fit is left in the queue
+    if( size > theBufferSize ) return Result(EMSGSIZE);
+
+    memcpy(theBuffer, slot + sizeof(uint32_t), size);
+    theReceivedSize = size;
+
+    header->tail.store(tail + 1, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( header->producer_waiting.load(std::memory_order_relaxed) ) {
+        header->producer_waiting.store(0, std::memory_order_relaxed);
+        futexWake(&header->tail);
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::SpscQueue::send(const std::string& theMsg) {
+    return sendData(theMsg.c_str(), theMsg.size()+1, nullptr);
+}
+
+ipclib::Result ipclib::SpscQueue::send(const std::string& theMsg, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return sendData(theMsg.c_str(), theMsg.size()+1, &tm);
+}
+
+ipclib::Result ipclib::SpscQueue::receive(std::string& theBuffer) {
+    if( header ) theBuffer.resize(header->max_msg_size);
+
+    size_t received;
+    Result res = receiveData(&theBuffer[0], theBuffer.size(), received, nullptr);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::SpscQueue::receive(std::string& theBuffer, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+
+    if( header ) theBuffer.resize(header->max_msg_size);
+
+    size_t received;
+    Result res = receiveData(&theBuffer[0], theBuffer.size(), received, &tm);
+    theBuffer.resize(strnlen(theBuffer.data(), received));
+    return res;
+}
+
+ipclib::Result ipclib::SpscQueue::sendBytes(const void* theData, const size_t theSize) {
+    return sendData(theData, theSize, nullptr);
+}
+
+ipclib::Result ipclib::SpscQueue::sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return sendData(theData, theSize, &tm);
+}
+
+ipclib::Result ipclib::SpscQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize) {
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, nullptr);
+}
+
+ipclib::Result ipclib::SpscQueue::receiveBytes(void* theBuffer, const size_t theBufferSize, size_t& theReceivedSize, const long theSeconds, const long theNanoSeconds) {
+    timespec tm;
+    getMonotonicDeadline(theSeconds, theNanoSeconds, tm);
+    return receiveData(theBuffer, theBufferSize, theReceivedSize, &tm);
+}
@@ -0,0 +1,308 @@
+#include "stats.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace {
+
+    const uint32_t STATS_MAGIC = 0x49505354;
+    const uint32_t STATS_INITIALIZING = 1;
+    const uint32_t STATS_HOLDER_NUMBER = 4096;
+
+    //which process uses which slot and how many times, so the slots of a process that died can be given back
+    struct StatsHolder {
+        pid_t process;
+        uint32_t slot;
+        uint32_t count;
+    };
+
+    //a zero filled segment only lacks its lock, whoever maps it first initializes that and then stamps the magic
+    //the lock is robust: a process killed while holding it does not lock everybody else out
+    struct StatsHeader {
+        std::atomic<uint32_t> magic;
+        uint32_t slot_number;
+        pthread_mutex_t lock;
+        alignas(ipclib::CACHE_LINE_SIZE) ipclib::StatsSlot slots[ipclib::STATS_SLOT_NUMBER];
+        StatsHolder holders[STATS_HOLDER_NUMBER];
+    };
+
+    const char* const STATS_KIND_NAMES[] = {
+        "none",
+        "msg_queue",
+        "semaphore",
+        "shared_memory"
+    };
+
+    StatsHeader* mapStatsSegment(const uid_t theUser, const bool toCreate) {
+        int fd = shm_open(ipclib::getStatsSegmentName(theUser).c_str(), toCreate ? O_RDWR | O_CREAT : O_RDONLY, S_IRUSR | S_IWUSR);
+        if( fd == -1 ) return nullptr;
+
+        struct stat st;
+        if( fstat(fd, &st) == -1 || ((size_t)(st.st_size) < sizeof(StatsHeader) && (!toCreate || ftruncate(fd, sizeof(StatsHeader)) == -1)) ) {
+            int err = errno;
+            close(fd);
+            errno = err;
+            return nullptr;
+        }
+
+        void* address = mmap(NULL, sizeof(StatsHeader), toCreate ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        int err = errno;
+        close(fd);
+        errno = err;
+        if( address == MAP_FAILED ) return nullptr;
+
+        StatsHeader* header = (StatsHeader*)(address);
+        if( !toCreate ) return header;
+
+        uint32_t expected = 0;
+        if( header->magic.compare_exchange_strong(expected, STATS_INITIALIZING, std::memory_order_acq_rel) ) {
+            pthread_mutexattr_t attribute;
+            pthread_mutexattr_init(&attribute);
+            pthread_mutexattr_setpshared(&attribute, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attribute, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&header->lock, &attribute);
+            pthread_mutexattr_destroy(&attribute);
+
+            header->slot_number = ipclib::STATS_SLOT_NUMBER;
+            header->magic.store(STATS_MAGIC, std::memory_order_release);
+            return header;
+        }
+
+        for( int attempts = 0; header->magic.load(std::memory_order_acquire) != STATS_MAGIC && attempts < 1000; attempts++ ) usleep(100);
+        if( header->magic.load(std::memory_order_acquire) != STATS_MAGIC || header->slot_number != ipclib::STATS_SLOT_NUMBER ) {
+            munmap(header, sizeof(StatsHeader));
+            errno = EAGAIN;
+            return nullptr;
+        }
+
+        return header;
+    }
+
+    //the segment is mapped once per process and never unmapped, slots may be released by destructors at exit
+    StatsHeader* getStatsHeader() {
+        static StatsHeader* header = mapStatsSegment(getuid(), true);
+        return header;
+    }
+
+    //the last user of a slot clears it, so the next object taking it starts from zero
+    void releaseSlot(StatsHeader* theHeader, const uint32_t theSlot, const uint32_t theCount) {
+        ipclib::StatsSlot& slot = theHeader->slots[theSlot];
+        if( slot.users.load(std::memory_order_relaxed) > theCount ) {
+            slot.users.fetch_sub(theCount, std::memory_order_relaxed);
+            return;
+        }
+
+        slot.users.store(0, std::memory_order_relaxed);
+        slot.kind.store(ipclib::STATS_NONE, std::memory_order_release);
+        slot.operations.store(0, std::memory_order_relaxed);
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.timeouts.store(0, std::memory_order_relaxed);
+        slot.would_block.store(0, std::memory_order_relaxed);
+        slot.errors.store(0, std::memory_order_relaxed);
+        slot.blocked_ns.store(0, std::memory_order_relaxed);
+        slot.depth.store(0, std::memory_order_relaxed);
+        slot.depth_high_water.store(0, std::memory_order_relaxed);
+        memset(slot.name, 0, sizeof(slot.name));
+    }
+
+    //processes which went away without disabling their metrics give their slots back here
+    void reclaimSlots(StatsHeader* theHeader) {
+        for( uint32_t i = 0; i < STATS_HOLDER_NUMBER; i++ ) {
+            StatsHolder& holder = theHeader->holders[i];
+            if( holder.process == 0 || holder.count == 0 ) continue;
+            if( kill(holder.process, 0) == 0 || errno != ESRCH ) continue;
+
+            releaseSlot(theHeader, holder.slot, holder.count);
+            memset(&holder, 0, sizeof(StatsHolder));
+        }
+    }
+
+    //the holder of a lock that died may have left a half updated slot or holder behind, reclaiming drops its entries
+    int lockHeader(StatsHeader* theHeader) {
+        int err = pthread_mutex_lock(&theHeader->lock);
+        if( err == EOWNERDEAD ) {
+            pthread_mutex_consistent(&theHeader->lock);
+            reclaimSlots(theHeader);
+            err = 0;
+        }
+
+        return err;
+    }
+
+    //finds the slot of theName, or takes a free one, and counts theProcess as one more of its users
+    ipclib::StatsSlot* acquireSlot(StatsHeader* theHeader, const ipclib::StatsKind theKind, const char* theName, const size_t theNameSize, const pid_t theProcess) {
+        uint32_t index = ipclib::STATS_SLOT_NUMBER;
+        uint32_t free_index = ipclib::STATS_SLOT_NUMBER;
+        for( uint32_t i = 0; i < ipclib::STATS_SLOT_NUMBER; i++ ) {
+            ipclib::StatsSlot& candidate = theHeader->slots[i];
+            uint32_t kind = candidate.kind.load(std::memory_order_relaxed);
+            if( kind == ipclib::STATS_NONE && free_index == ipclib::STATS_SLOT_NUMBER ) free_index = i;
+            else if( kind == (uint32_t)(theKind) && strncmp(candidate.name, theName, theNameSize) == 0 ) {
+                index = i;
+                break;
+            }
+        }
+
+        if( index == ipclib::STATS_SLOT_NUMBER ) index = free_index;
+        if( index == ipclib::STATS_SLOT_NUMBER ) return nullptr;
+
+        StatsHolder* holder = nullptr;
+        StatsHolder* free_holder = nullptr;
+        for( uint32_t i = 0; i < STATS_HOLDER_NUMBER && !holder; i++ ) {
+            StatsHolder& candidate = theHeader->holders[i];
+            if( candidate.process == theProcess && candidate.slot == index && candidate.count ) holder = &candidate;
+            else if( candidate.count == 0 && !free_holder ) free_holder = &candidate;
+        }
+
+        if( !holder ) holder = free_holder;
+        if( !holder ) return nullptr;
+
+        ipclib::StatsSlot& slot = theHeader->slots[index];
+        if( slot.kind.load(std::memory_order_relaxed) == ipclib::STATS_NONE ) {
+            memcpy(slot.name, theName, theNameSize);
+            slot.kind.store(theKind, std::memory_order_release);
+        }
+
+        holder->process = theProcess;
+        holder->slot = index;
+        holder->count++;
+        slot.users.fetch_add(1, std::memory_order_relaxed);
+        return &slot;
+    }
+
+}
+
+const char* ipclib::getStatsKindName(const StatsKind theKind) {
+    if( theKind > STATS_SHARED_MEMORY ) return "unknown";
+    else return STATS_KIND_NAMES[theKind];
+}
+
+std::string ipclib::getStatsSegmentName(const uid_t theUser) {
+    return "/ipclib_stats." + std::to_string(theUser);
+}
+
+ipclib::Result ipclib::getStats(const uid_t theUser, std::vector<StatsSnapshot>& theSnapshots) {
+    theSnapshots.clear();
+
+    StatsHeader* header = mapStatsSegment(theUser, false);
+    if( !header ) return Result(errno);
+
+    if( header->magic.load(std::memory_order_acquire) != STATS_MAGIC || header->slot_number != STATS_SLOT_NUMBER ) {
+        munmap(header, sizeof(StatsHeader));
+        return Result(EINVAL, "Not an ipclib stats segment");
+    }
+
+    for( uint32_t i = 0; i < STATS_SLOT_NUMBER; i++ ) {
+        const StatsSlot& slot = header->slots[i];
+        uint32_t kind = slot.kind.load(std::memory_order_acquire);
+        if( kind == STATS_NONE ) continue;
+
+        StatsSnapshot snapshot;
+        snapshot.kind = (StatsKind)(kind);
+        snapshot.users = slot.users.load(std::memory_order_relaxed);
+        snapshot.name = std::string(slot.name, strnlen(slot.name, sizeof(slot.name)));
+        snapshot.operations = slot.operations.load(std::memory_order_relaxed);
+        snapshot.bytes = slot.bytes.load(std::memory_order_relaxed);
+        snapshot.timeouts = slot.timeouts.load(std::memory_order_relaxed);
+        snapshot.would_block = slot.would_block.load(std::memory_order_relaxed);
+        snapshot.errors = slot.errors.load(std::memory_order_relaxed);
+        snapshot.blocked_ns = slot.blocked_ns.load(std::memory_order_relaxed);
+        snapshot.depth = slot.depth.load(std::memory_order_relaxed);
+        snapshot.depth_high_water = slot.depth_high_water.load(std::memory_order_relaxed);
+        theSnapshots.push_back(snapshot);
+    }
+
+    munmap(header, sizeof(StatsHeader));
+    return Result(Result::SUCCESS);
+}
+
+std::atomic<uint32_t> ipclib::Metrics::process_generation(0);
+
+long ipclib::Metrics::now() {
+    timespec tm;
+    clock_gettime(CLOCK_MONOTONIC, &tm);
+    return tm.tv_sec * 1000000000L + tm.tv_nsec;
+}
+
+//the child is not a user of any slot its parent enabled, so every Metrics it inherited goes quiet
+void ipclib::Metrics::onFork() {
+    process_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+ipclib::Result ipclib::Metrics::enable(const StatsKind theKind, const std::string& theName, const int64_t theDepth) {
+    disable();
+
+    if( theKind == STATS_NONE ) return Result(EINVAL);
+
+    StatsHeader* header = getStatsHeader();
+    if( !header ) return Result(errno ? errno : EINVAL);
+
+    static const bool fork_handler = pthread_atfork(nullptr, nullptr, onFork) == 0;
+    if( !fork_handler ) return Result(ENOMEM);
+
+    //names longer than a slot can hold are truncated, so they may end up sharing a slot
+    char name[sizeof(((StatsSlot*)(nullptr))->name)];
+    memset(name, 0, sizeof(name));
+    strncpy(name, theName.c_str(), sizeof(name) - 1);
+
+    int err = lockHeader(header);
+    if( err ) return Result(err);
+
+    pid_t process = getpid();
+    StatsSlot* acquired = acquireSlot(header, theKind, name, sizeof(name), process);
+    if( !acquired ) {
+        reclaimSlots(header);
+        acquired = acquireSlot(header, theKind, name, sizeof(name), process);
+    }
+
+    //the object itself knows its depth better than the counters of whoever used the slot before
+    if( acquired ) {
+        acquired->depth.store(theDepth, std::memory_order_relaxed);
+        int64_t high_water = acquired->depth_high_water.load(std::memory_order_relaxed);
+        if( theDepth > high_water ) acquired->depth_high_water.store(theDepth, std::memory_order_relaxed);
+    }
+
+    pthread_mutex_unlock(&header->lock);
+
+    if( !acquired ) return Result(ENOSPC, "The stats segment is full");
+
+    slot = acquired;
+    generation = process_generation.load(std::memory_order_relaxed);
+    return Result(Result::SUCCESS);
+}
+
+void ipclib::Metrics::disable() {
+    if( !slot ) return;
+
+    //a copy inherited through fork() never counted as a user, so it has nothing to give back
+    if( generation != process_generation.load(std::memory_order_relaxed) ) {
+        slot = nullptr;
+        return;
+    }
+
+    StatsHeader* header = getStatsHeader();
+    if( lockHeader(header) ) {
+        slot = nullptr;
+        return;
+    }
+
+    uint32_t index = slot - header->slots;
+    pid_t process = getpid();
+    for( uint32_t i = 0; i < STATS_HOLDER_NUMBER; i++ ) {
+        StatsHolder& holder = header->holders[i];
+        if( holder.process != process || holder.slot != index || holder.count == 0 ) continue;
+
+        if( --holder.count == 0 ) memset(&holder, 0, sizeof(StatsHolder));
+        releaseSlot(header, index, 1);
+        break;
+    }
+
+    pthread_mutex_unlock(&header->lock);
+    slot = nullptr;
+}
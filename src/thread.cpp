@@ -1,70 +1,74 @@
 #include "thread.h"
 
+#include <unistd.h>
+#include <sys/syscall.h>
 #include <string.h>
 
-#ifdef NDEBUG
-#include <iostream>
-#endif
+#include "trace.h"
 
-ipclib::Result ipclib::Thread::run(void* theFunction(void*), void* theParameter) {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: starting a new thread...";
-    #endif
+int ipclib::Thread::getCurrentCpu() {
+    unsigned int cpu;
+    if( syscall(SYS_getcpu, &cpu, NULL, NULL) == -1 ) return -1;
+    else return cpu;
+}
 
-    int err;
-    if( (err = pthread_create(&thread_id, NULL, theFunction, theParameter)) != 0 ) {
-        #ifdef NDEBUG
-        std::cout << "FAILED\n";
-        #endif
-        return Result(err, strerror(err));
+int ipclib::Thread::getCurrentNumaNode() {
+    unsigned int node;
+    if( syscall(SYS_getcpu, NULL, &node, NULL) == -1 ) return -1;
+    else return node;
+}
+
+ipclib::Result ipclib::Thread::run(void* theFunction(void*), void* theParameter, const ThreadOptions& theOptions) {
+    //the affinity and the scheduling policy are set through the attributes, so the thread never runs unpinned
+    pthread_attr_t attributes;
+    bool has_attributes = !theOptions.isDefault();
+    if( has_attributes ) {
+        Result res = theOptions.getAttributes(attributes);
+        if( !res ) {
+            IPCLIB_TRACE_EVENT(TRACE_THREAD_RUN, "", res.getError(), 0);
+            return res;
+        }
+    }
+
+    int err = pthread_create(&thread_id, has_attributes ? &attributes : NULL, theFunction, theParameter);
+    if( has_attributes ) pthread_attr_destroy(&attributes);
+
+    if( err != 0 ) {
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_RUN, "", err, 0);
+        return Result(err);
     }
 
     else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        //a name which can not be set is not worth failing a running thread for
+        theOptions.applyName(thread_id);
+
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_RUN, "", 0, 0);
         return Result(Result::SUCCESS);
     }
 }
 
 ipclib::Result ipclib::Thread::join(void** theReturnValue) {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: joining on thread " << thread_id << "...";
-    #endif
-
     int err;
     if( (err = pthread_join(thread_id, theReturnValue)) != 0 ) {
-        #ifdef NDEBUG
-        std::cout << "FAILED\n";
-        #endif
-        return Result(err, strerror(err));
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_JOIN, "", err, 0);
+        return Result(err);
     }
 
     else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_JOIN, "", 0, 0);
         return Result(Result::SUCCESS);
     }
 }
 
 ipclib::Result ipclib::Thread::cancel() {
-    #ifdef NDEBUG
-    std::cout << "IPCLIB: Sending a cancel request to " << thread_id << "...";
-    #endif
-
     int err;
     if( (err = pthread_cancel(thread_id)) != 0 ) {
-        #ifdef NDEBUG
-        std::cout << "FAILED\n";
-        #endif
-        return Result(err, strerror(err));
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_CANCEL, "", err, 0);
+        return Result(err);
     }
 
     else {
-        #ifdef NDEBUG
-        std::cout << "SUCCESS\n";
-        #endif
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_CANCEL, "", 0, 0);
         return Result(Result::SUCCESS);
     }
 }
@@ -0,0 +1,67 @@
+#include "thread_options.h"
+
+#include <sched.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+
+ipclib::ThreadOptions::ThreadOptions() {
+    policy = SCHED_OTHER;
+    priority = 0;
+    stack_size = 0;
+}
+
+//on success theAttributes is initialized and the caller has to destroy it
+ipclib::Result ipclib::ThreadOptions::getAttributes(pthread_attr_t& theAttributes) const {
+    int err;
+    if( (err = pthread_attr_init(&theAttributes)) != 0 ) return Result(err);
+
+    if( !cpus.empty() ) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+
+        for( size_t i = 0; i < cpus.size(); i++ ) {
+            if( cpus[i] < 0 || cpus[i] >= CPU_SETSIZE ) {
+                pthread_attr_destroy(&theAttributes);
+                return Result(EINVAL);
+            }
+
+            CPU_SET(cpus[i], &cpu_set);
+        }
+
+        if( (err = pthread_attr_setaffinity_np(&theAttributes, sizeof(cpu_set_t), &cpu_set)) != 0 ) {
+            pthread_attr_destroy(&theAttributes);
+            return Result(err);
+        }
+    }
+
+    //without PTHREAD_EXPLICIT_SCHED the new thread silently inherits the policy of its creator
+    if( policy != SCHED_OTHER || priority != 0 ) {
+        sched_param param;
+        memset(&param, 0, sizeof(sched_param));
+        param.sched_priority = priority;
+
+        if( (err = pthread_attr_setinheritsched(&theAttributes, PTHREAD_EXPLICIT_SCHED)) != 0 || (err = pthread_attr_setschedpolicy(&theAttributes, policy)) != 0 || (err = pthread_attr_setschedparam(&theAttributes, &param)) != 0 ) {
+            pthread_attr_destroy(&theAttributes);
+            return Result(err);
+        }
+    }
+
+    if( stack_size != 0 ) {
+        size_t size = stack_size < (size_t)(PTHREAD_STACK_MIN) ? (size_t)(PTHREAD_STACK_MIN) : stack_size;
+        if( (err = pthread_attr_setstacksize(&theAttributes, size)) != 0 ) {
+            pthread_attr_destroy(&theAttributes);
+            return Result(err);
+        }
+    }
+
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::ThreadOptions::applyName(const pthread_t theThread) const {
+    if( thread_name.empty() ) return Result(Result::SUCCESS);
+
+    int err;
+    if( (err = pthread_setname_np(theThread, thread_name.substr(0, 15).c_str())) != 0 ) return Result(err);
+    else return Result(Result::SUCCESS);
+}
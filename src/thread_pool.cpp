@@ -0,0 +1,190 @@
+#include "thread_pool.h"
+
+#include <thread>
+#include <errno.h>
+#include <string.h>
+
+#include "trace.h"
+
+namespace {
+    thread_local void* current_worker = nullptr;
+}
+
+ipclib::ThreadPool::ThreadPool(const unsigned int theThreadNumber) : pending(0), sleep_event(0), sleepers(0), stopping(false), posting(0), next_worker(0), failed(0) {
+    start(theThreadNumber);
+}
+
+ipclib::Result ipclib::ThreadPool::start(const unsigned int theThreadNumber) {
+    if( !workers.empty() ) return Result(EBUSY);
+
+    unsigned int thread_number = theThreadNumber;
+    if( thread_number == 0 ) thread_number = std::thread::hardware_concurrency();
+    if( thread_number == 0 ) thread_number = 1;
+
+    stopping.store(false, std::memory_order_relaxed);
+
+    for( unsigned int i = 0; i < thread_number; i++ ) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->pool = this;
+        worker->index = i;
+        workers.push_back(std::move(worker));
+    }
+
+    for( unsigned int i = 0; i < thread_number; i++ ) {
+        Result res = workers[i]->thread.run(workerMain, workers[i].get());
+        if( !res ) {
+            IPCLIB_TRACE_EVENT(TRACE_THREAD_POOL_START, "", res.getError(), thread_number);
+            workers.resize(i);
+            stop();
+            return res;
+        }
+    }
+
+    IPCLIB_TRACE_EVENT(TRACE_THREAD_POOL_START, "", 0, thread_number);
+    return Result(Result::SUCCESS);
+}
+
+ipclib::Result ipclib::ThreadPool::stop() {
+    if( workers.empty() ) return Result(Result::SUCCESS);
+
+    Worker* worker = (Worker*)(current_worker);
+    if( worker && worker->pool == this ) return Result(EDEADLK, "Thread pool stopped from one of its own workers");
+
+    //workers finish every queued task before they leave
+    stopping.store(true, std::memory_order_seq_cst);
+
+    //pairs with post(): a post either sees stopping or is waited for here, so its task is queued before the drain
+    while( posting.load(std::memory_order_seq_cst) ) std::this_thread::yield();
+
+    sleep_event.fetch_add(1, std::memory_order_release);
+    futexWake(&sleep_event);
+
+    Result res(Result::SUCCESS);
+    for( size_t i = 0; i < workers.size(); i++ ) {
+        Result joined = workers[i]->thread.join();
+        if( !joined ) res = joined;
+    }
+
+    workers.clear();
+
+    IPCLIB_TRACE_EVENT(TRACE_THREAD_POOL_STOP, "", res.getError(), 0);
+    return res;
+}
+
+void ipclib::ThreadPool::push(Worker& theWorker, Task&& theTask) {
+    //counted before it is queued, so a stopping worker never sees pending at zero while a task is still on its way
+    pending.fetch_add(1, std::memory_order_seq_cst);
+
+    theWorker.lock.lock();
+    theWorker.tasks.push_back(std::move(theTask));
+    theWorker.lock.unlock();
+
+    //pairs with park(): either the sleeper sees the new task or we see the sleeper
+    if( sleepers.load(std::memory_order_seq_cst) ) {
+        sleep_event.fetch_add(1, std::memory_order_release);
+        futexWake(&sleep_event, 1);
+    }
+}
+
+ipclib::Result ipclib::ThreadPool::post(Task theTask) {
+    posting.fetch_add(1, std::memory_order_seq_cst);
+    if( stopping.load(std::memory_order_seq_cst) || workers.empty() ) {
+        posting.fetch_sub(1, std::memory_order_release);
+        return Result(ESRCH, "Thread pool is not running");
+    }
+
+    Worker* worker = (Worker*)(current_worker);
+    if( !worker || worker->pool != this ) worker = workers[next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size()].get();
+
+    push(*worker, std::move(theTask));
+    posting.fetch_sub(1, std::memory_order_release);
+    return Result(Result::SUCCESS);
+}
+
+void ipclib::ThreadPool::runTask(Task& theTask) {
+    try {
+        theTask();
+    }
+
+    catch( ... ) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        IPCLIB_TRACE_EVENT(TRACE_THREAD_POOL_TASK_FAILED, "", ECANCELED, 0);
+
+        if( exception_handler ) {
+            try {
+                exception_handler(std::current_exception());
+            }
+
+            catch( ... ) {}
+        }
+    }
+
+    theTask = nullptr;
+}
+
+bool ipclib::ThreadPool::popTask(Worker& theWorker, Task& theTask) {
+    theWorker.lock.lock();
+    if( theWorker.tasks.empty() ) {
+        theWorker.lock.unlock();
+        return false;
+    }
+
+    theTask = std::move(theWorker.tasks.back());
+    theWorker.tasks.pop_back();
+    theWorker.lock.unlock();
+
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ipclib::ThreadPool::stealTask(const unsigned int theThief, Task& theTask) {
+    for( size_t i = 1; i < workers.size(); i++ ) {
+        Worker& victim = *workers[(theThief + i) % workers.size()];
+        if( !victim.lock.tryLock() ) continue;
+
+        if( !victim.tasks.empty() ) {
+            theTask = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            victim.lock.unlock();
+
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        victim.lock.unlock();
+    }
+
+    return false;
+}
+
+void ipclib::ThreadPool::park() {
+    for( unsigned int i = 0; i < SPIN_COUNT; i++ ) {
+        if( pending.load(std::memory_order_relaxed) || stopping.load(std::memory_order_relaxed) ) return;
+        cpuRelax();
+    }
+
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t event = sleep_event.load(std::memory_order_acquire);
+    if( !pending.load(std::memory_order_seq_cst) && !stopping.load(std::memory_order_seq_cst) ) futexWait(&sleep_event, event);
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void* ipclib::ThreadPool::workerMain(void* theWorker) {
+    Worker& worker = *(Worker*)(theWorker);
+    ThreadPool& pool = *worker.pool;
+    current_worker = &worker;
+
+    Task task;
+    while( true ) {
+        if( pool.popTask(worker, task) || pool.stealTask(worker.index, task) ) {
+            pool.runTask(task);
+            continue;
+        }
+
+        if( pool.stopping.load(std::memory_order_acquire) && !pool.pending.load(std::memory_order_acquire) ) break;
+        pool.park();
+    }
+
+    current_worker = nullptr;
+    return nullptr;
+}
@@ -0,0 +1,259 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "atomic_wait.h"
+
+namespace {
+
+    const uint32_t TRACE_MAGIC = 0x49505452;
+
+    struct TraceRing {
+        alignas(ipclib::CACHE_LINE_SIZE) std::atomic<uint64_t> head;
+        std::atomic<uint32_t> owner;
+        alignas(ipclib::CACHE_LINE_SIZE) ipclib::TraceEvent events[ipclib::TRACE_RING_SIZE];
+    };
+
+    struct TraceHeader {
+        std::atomic<uint32_t> magic;
+        uint32_t ring_number;
+        uint32_t ring_size;
+        std::atomic<uint64_t> dropped;
+        alignas(ipclib::CACHE_LINE_SIZE) TraceRing rings[ipclib::TRACE_RING_NUMBER];
+    };
+
+    const char* const TRACE_OP_NAMES[] = {
+        "msg_queue.create",
+        "msg_queue.close",
+        "msg_queue.get_attribute",
+        "msg_queue.destroy",
+        "msg_queue.send",
+        "msg_queue.receive",
+        "msg_queue.send_batch",
+        "msg_queue.receive_batch",
+        "msg_queue.drain",
+        "semaphore.create",
+        "semaphore.close",
+        "semaphore.wait",
+        "semaphore.timed_wait",
+        "semaphore.signal",
+        "semaphore.get_value",
+        "semaphore.destroy",
+        "shared_memory.create",
+        "shared_memory.close",
+        "shared_memory.destroy",
+        "shared_region.create",
+        "shared_region.close",
+        "shared_region.destroy",
+        "shared_arena.create",
+        "spsc_queue.create",
+        "mpmc_queue.create",
+        "buffer_pool.create",
+        "broadcast_ring.create",
+        "event.create",
+        "reactor.create",
+        "reactor.run",
+        "thread.run",
+        "thread.join",
+        "thread.cancel",
+        "thread_pool.start",
+        "thread_pool.stop",
+        "thread_pool.task_failed"
+    };
+
+    static_assert(sizeof(TRACE_OP_NAMES) / sizeof(TRACE_OP_NAMES[0]) == ipclib::TRACE_OP_NUMBER, "every trace operation needs a name");
+
+    //the segment is unlinked at exit but never unmapped, so objects destroyed after it can still trace safely
+    //a crashed process leaves its segment behind for a post mortem dump
+    class TraceSegment {
+        private:
+            std::mutex mutex;
+            std::string name;
+            TraceHeader* header;
+            bool opened;
+
+        public:
+            TraceSegment() { header = nullptr; opened = false; }
+            ~TraceSegment() { if( header ) shm_unlink(name.c_str()); }
+
+            TraceHeader* open();
+            void reset();
+    };
+
+    TraceSegment segment;
+
+    TraceHeader* TraceSegment::open() {
+        std::lock_guard<std::mutex> guard(mutex);
+        if( opened ) return header;
+        opened = true;
+
+        name = ipclib::getTraceSegmentName(getpid());
+
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+        if( fd == -1 ) return nullptr;
+
+        if( ftruncate(fd, sizeof(TraceHeader)) == 0 ) {
+            void* address = mmap(NULL, sizeof(TraceHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if( address != MAP_FAILED ) header = (TraceHeader*)(address);
+        }
+
+        close(fd);
+
+        if( !header ) {
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        header->ring_number = ipclib::TRACE_RING_NUMBER;
+        header->ring_size = ipclib::TRACE_RING_SIZE;
+        header->magic.store(TRACE_MAGIC, std::memory_order_release);
+        return header;
+    }
+
+    //gives the ring back once its thread exits, the events stay readable until the next owner overwrites them
+    class RingOwnership {
+        public:
+            TraceRing* ring;
+            uint32_t thread;
+            bool claimed;
+
+            RingOwnership() { ring = nullptr; thread = syscall(SYS_gettid); claimed = false; }
+            ~RingOwnership() { if( ring ) ring->owner.store(0, std::memory_order_release); }
+
+            TraceRing* claim(TraceHeader* theHeader) {
+                claimed = true;
+                for( uint32_t i = 0; i < ipclib::TRACE_RING_NUMBER; i++ ) {
+                    TraceRing& candidate = theHeader->rings[(thread + i) % ipclib::TRACE_RING_NUMBER];
+                    uint32_t expected = 0;
+                    if( candidate.owner.compare_exchange_strong(expected, thread, std::memory_order_acq_rel) ) {
+                        ring = &candidate;
+                        break;
+                    }
+                }
+
+                return ring;
+            }
+    };
+
+    thread_local RingOwnership ownership;
+
+    //a forked child must not keep writing into the rings of its parent
+    void TraceSegment::reset() {
+        if( header ) munmap(header, sizeof(TraceHeader));
+        header = nullptr;
+        opened = false;
+        new (&mutex) std::mutex();
+
+        ownership.ring = nullptr;
+        ownership.thread = syscall(SYS_gettid);
+        ownership.claimed = false;
+    }
+
+    void resetAfterFork() {
+        segment.reset();
+    }
+
+}
+
+const char* ipclib::getTraceOpName(const uint16_t theOp) {
+    if( theOp >= TRACE_OP_NUMBER ) return "unknown";
+    else return TRACE_OP_NAMES[theOp];
+}
+
+std::string ipclib::getTraceSegmentName(const pid_t theProcess) {
+    return "/ipclib_trace." + std::to_string(theProcess);
+}
+
+void ipclib::traceEvent(const TraceOp theOp, const char* theObject, const int theError, const size_t theSize) {
+    TraceRing* ring = ownership.ring;
+    if( !ring ) {
+        if( ownership.claimed ) return;
+
+        static std::once_flag fork_handler;
+        std::call_once(fork_handler, []() { pthread_atfork(NULL, NULL, resetAfterFork); });
+
+        TraceHeader* header = segment.open();
+        if( !header ) return;
+
+        //more live threads than rings: the extra ones only count what they could not record
+        if( !(ring = ownership.claim(header)) ) {
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    //single writer per ring, readers detect the slots overwritten while they copied by rereading head
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    TraceEvent& event = ring->events[head & (TRACE_RING_SIZE - 1)];
+    event.timestamp = (uint64_t)(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+    event.thread = ownership.thread;
+    event.op = theOp;
+    event.reserved = 0;
+    event.error = theError;
+    event.size = theSize;
+    strncpy(event.object, theObject, sizeof(event.object) - 1);
+    event.object[sizeof(event.object) - 1] = '\0';
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+ipclib::Result ipclib::readTrace(const pid_t theProcess, std::vector<TraceEvent>& theEvents, uint64_t& theDroppedNumber) {
+    theEvents.clear();
+    theDroppedNumber = 0;
+
+    int fd = shm_open(getTraceSegmentName(theProcess).c_str(), O_RDONLY, 0);
+    if( fd == -1 ) return Result(errno);
+
+    struct stat st;
+    if( fstat(fd, &st) == -1 || (size_t)(st.st_size) < sizeof(TraceHeader) ) {
+        close(fd);
+        return Result(EINVAL, "Not an ipclib trace segment");
+    }
+
+    void* address = mmap(NULL, sizeof(TraceHeader), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if( address == MAP_FAILED ) return Result(errno);
+
+    const TraceHeader* header = (const TraceHeader*)(address);
+    if( header->magic.load(std::memory_order_acquire) != TRACE_MAGIC || header->ring_number != TRACE_RING_NUMBER || header->ring_size != TRACE_RING_SIZE ) {
+        munmap(address, sizeof(TraceHeader));
+        return Result(EINVAL, "Not an ipclib trace segment");
+    }
+
+    std::vector<TraceEvent> copied(TRACE_RING_SIZE);
+    for( uint32_t i = 0; i < TRACE_RING_NUMBER; i++ ) {
+        const TraceRing& ring = header->rings[i];
+        uint64_t before = ring.head.load(std::memory_order_acquire);
+        if( !before ) continue;
+
+        uint64_t first = before > TRACE_RING_SIZE ? before - TRACE_RING_SIZE : 0;
+        for( uint64_t j = first; j < before; j++ ) memcpy(&copied[j - first], &ring.events[j & (TRACE_RING_SIZE - 1)], sizeof(TraceEvent));
+
+        //the writer may be filling the slot of index after - TRACE_RING_SIZE right now
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = ring.head.load(std::memory_order_relaxed);
+        uint64_t valid = after >= TRACE_RING_SIZE ? after - TRACE_RING_SIZE + 1 : 0;
+
+        for( uint64_t j = std::max(first, valid); j < before; j++ ) theEvents.push_back(copied[j - first]);
+    }
+
+    theDroppedNumber = header->dropped.load(std::memory_order_relaxed);
+    munmap(address, sizeof(TraceHeader));
+
+    std::stable_sort(theEvents.begin(), theEvents.end(), [](const TraceEvent& first, const TraceEvent& second) { return first.timestamp < second.timestamp; });
+    return Result(Result::SUCCESS);
+}
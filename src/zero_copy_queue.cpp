@@ -0,0 +1,96 @@
+#include "zero_copy_queue.h"
+
+#include <errno.h>
+#include <string.h>
+
+ipclib::ZeroCopyQueue::ZeroCopyQueue(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theSlotNumber, const long theSlotSize) {
+    create(theName, toCreate, toCreateExclusively, isNonBlocking, theMaxMsg, theSlotNumber, theSlotSize);
+}
+
+//the queue and the pool live in different namespaces, /dev/mqueue and /dev/shm, so they can share the name
+ipclib::Result ipclib::ZeroCopyQueue::create(const std::string& theName, const bool toCreate, const bool toCreateExclusively, const bool isNonBlocking, const long theMaxMsg, const long theSlotNumber, const long theSlotSize) {
+    Result res = pool.create(theName, toCreate, toCreateExclusively, isNonBlocking, theSlotNumber, theSlotSize);
+    if( !res ) return res;
+
+    //a pool this call created is not left behind without its queue
+    res = queue.create(theName, toCreate, toCreateExclusively, isNonBlocking, MsgQueue::READ_AND_WRITE, theMaxMsg, sizeof(BufferPool::Descriptor));
+    if( !res && pool.isOwner() ) pool.destroy();
+    return res;
+}
+
+ipclib::Result ipclib::ZeroCopyQueue::destroy() {
+    Result res = queue.destroy();
+    Result pool_res = pool.destroy();
+    return !res ? res : pool_res;
+}
+
+//on failure the buffer still belongs to the caller, who can retry or release it
+ipclib::Result ipclib::ZeroCopyQueue::send(const Buffer& theBuffer, const size_t theLength, const size_t theOffset) {
+    BufferPool::Descriptor descriptor;
+    Result res = pool.getDescriptor(theBuffer, theLength, theOffset, descriptor);
+    if( !res ) return res;
+
+    return queue.send(descriptor);
+}
+
+ipclib::Result ipclib::ZeroCopyQueue::send(const Buffer& theBuffer, const size_t theLength, const size_t theOffset, const long theSeconds, const long theNanoSeconds) {
+    BufferPool::Descriptor descriptor;
+    Result res = pool.getDescriptor(theBuffer, theLength, theOffset, descriptor);
+    if( !res ) return res;
+
+    return queue.send(descriptor, theSeconds, theNanoSeconds);
+}
+
+ipclib::Result ipclib::ZeroCopyQueue::sendBytes(const void* theData, const size_t theSize) {
+    if( theSize > (size_t)(pool.getSlotSize()) ) return Result(EMSGSIZE);
+
+    Buffer buffer;
+    Result res = pool.acquire(buffer);
+    if( !res ) return res;
+
+    memcpy(buffer.data, theData, theSize);
+
+    res = send(buffer, theSize);
+    if( !res ) pool.release(buffer);
+    return res;
+}
+
+//the timeout covers the whole call, waiting for a free slot and then for room in the queue
+ipclib::Result ipclib::ZeroCopyQueue::sendBytes(const void* theData, const size_t theSize, const long theSeconds, const long theNanoSeconds) {
+    if( theSize > (size_t)(pool.getSlotSize()) ) return Result(EMSGSIZE);
+
+    Deadline deadline(theSeconds, theNanoSeconds);
+    Buffer buffer;
+    Result res = pool.acquire(buffer, deadline);
+    if( !res ) return res;
+
+    memcpy(buffer.data, theData, theSize);
+
+    BufferPool::Descriptor descriptor;
+    res = pool.getDescriptor(buffer, theSize, 0, descriptor);
+    if( res ) res = queue.send(descriptor, deadline);
+    if( !res ) pool.release(buffer);
+    return res;
+}
+
+ipclib::Result ipclib::ZeroCopyQueue::getView(const BufferPool::Descriptor& theDescriptor, View& theView) {
+    theView.descriptor = theDescriptor;
+    theView.size = theDescriptor.length;
+    return pool.getData(theDescriptor, theView.data);
+}
+
+ipclib::Result ipclib::ZeroCopyQueue::receive(View& theView) {
+    BufferPool::Descriptor descriptor;
+    Result res = queue.receive(descriptor);
+    if( !res ) return res;
+
+    return getView(descriptor, theView);
+}
+
+ipclib::Result ipclib::ZeroCopyQueue::receive(View& theView, const long theSeconds, const long theNanoSeconds) {
+    BufferPool::Descriptor descriptor;
+    Result res = queue.receive(descriptor, theSeconds, theNanoSeconds);
+    if( !res ) return res;
+
+    return getView(descriptor, theView);
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stats.h"
+
+//prints the metrics every process of a user exported, -u picks another user and -w repeats every given seconds
+int main(int argc, char** argv) {
+    uid_t user = getuid();
+    long interval = 0;
+
+    for( int i = 1; i < argc; i++ ) {
+        if( strcmp(argv[i], "-u") == 0 && i + 1 < argc ) user = atol(argv[++i]);
+        else if( strcmp(argv[i], "-w") == 0 && i + 1 < argc ) interval = atol(argv[++i]);
+        else {
+            std::cerr << "usage: " << argv[0] << " [-u uid] [-w seconds]\n";
+            return 1;
+        }
+    }
+
+    while( true ) {
+        std::vector<ipclib::StatsSnapshot> snapshots;
+        ipclib::Result res = ipclib::getStats(user, snapshots);
+        if( !res ) {
+            std::cerr << "cannot read the stats of user " << user << ": " << res.getDescription() << "\n";
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(14) << "kind" << std::setw(32) << "name" << std::right
+                  << std::setw(6) << "users" << std::setw(14) << "operations" << std::setw(16) << "bytes"
+                  << std::setw(10) << "timeouts" << std::setw(10) << "eagain" << std::setw(8) << "errors"
+                  << std::setw(14) << "blocked_us" << std::setw(8) << "depth" << std::setw(8) << "max" << "\n";
+
+        for( size_t i = 0; i < snapshots.size(); i++ ) {
+            const ipclib::StatsSnapshot& snapshot = snapshots[i];
+            std::cout << std::left << std::setw(14) << ipclib::getStatsKindName(snapshot.kind) << std::setw(32) << snapshot.name << std::right
+                      << std::setw(6) << snapshot.users << std::setw(14) << snapshot.operations << std::setw(16) << snapshot.bytes
+                      << std::setw(10) << snapshot.timeouts << std::setw(10) << snapshot.would_block << std::setw(8) << snapshot.errors
+                      << std::setw(14) << snapshot.blocked_ns / 1000 << std::setw(8) << snapshot.depth << std::setw(8) << snapshot.depth_high_water << "\n";
+        }
+
+        if( interval <= 0 ) return 0;
+
+        std::cout << "\n";
+        sleep(interval);
+    }
+}
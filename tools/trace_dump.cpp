@@ -0,0 +1,42 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "trace.h"
+
+//prints the trace rings of a running (or crashed) process, -r also removes the segment afterwards
+int main(int argc, char** argv) {
+    if( argc < 2 || argc > 3 || (argc == 3 && strcmp(argv[1], "-r") != 0) ) {
+        std::cerr << "usage: " << argv[0] << " [-r] <pid>\n";
+        return 1;
+    }
+
+    pid_t pid = atoi(argv[argc - 1]);
+
+    std::vector<ipclib::TraceEvent> events;
+    uint64_t dropped;
+    ipclib::Result res = ipclib::readTrace(pid, events, dropped);
+    if( !res ) {
+        std::cerr << "cannot read the trace of process " << pid << ": " << res.getDescription() << "\n";
+        return 1;
+    }
+
+    uint64_t start = events.empty() ? 0 : events.front().timestamp;
+    for( size_t i = 0; i < events.size(); i++ ) {
+        const ipclib::TraceEvent& event = events[i];
+        std::cout << std::setw(14) << (event.timestamp - start) << " ns  "
+                  << std::setw(7) << event.thread << "  "
+                  << std::left << std::setw(24) << ipclib::getTraceOpName(event.op) << std::right
+                  << std::setw(5) << event.error << " "
+                  << std::setw(10) << event.size << "  "
+                  << event.object << "\n";
+    }
+
+    if( dropped ) std::cout << dropped << " events dropped by threads without a ring\n";
+
+    if( argc == 3 ) shm_unlink(ipclib::getTraceSegmentName(pid).c_str());
+    return 0;
+}